@@ -0,0 +1,141 @@
+#define _GNU_SOURCE /* for madvise(), MAP_HUGETLB, syscall() and sched_setaffinity() */
+
+#include "alloc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define HUGE_PAGE_SIZE ((size_t) 2 << 20)
+#define PAGE_SIZE ((size_t) 4096)
+
+/* from linux/mempolicy.h, which is not always installed */
+#define MPOL_INTERLEAVE 3
+#define MPOL_LOCAL 4
+#define MAX_NODES 1024
+
+const char *alloc_mode_names[alloc_mode_end] = {
+    "malloc",
+    "thp",
+    "hugetlb",
+    "local",
+    "interleave"
+};
+
+static size_t round_up(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+/* reads the online nodes (ex. "0-1,4") into a bit mask of MAX_NODES bits */
+static int online_nodes(unsigned long *mask) {
+    char line[256];
+    const char *p = line;
+    FILE *f = fopen("/sys/devices/system/node/online", "r");
+    memset(mask, 0, MAX_NODES / 8);
+    if (f == NULL) {
+        mask[0] = 1; /* no NUMA support, so there is only node 0 */
+        return 1;
+    }
+    if (fgets(line, sizeof(line), f) == NULL) {
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+    while (*p >= '0' && *p <= '9') {
+        char *end;
+        long first = strtol(p, &end, 10), last = first;
+        if (*end == '-') {
+            last = strtol(end + 1, &end, 10);
+        }
+        for (long node = first; node <= last && node < MAX_NODES; node++) {
+            mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+    return 1;
+}
+
+static int bind_memory(void *addr, size_t size, int policy) {
+#ifdef SYS_mbind
+    unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long))];
+    if (policy == MPOL_LOCAL) {
+        return syscall(SYS_mbind, addr, size, policy, NULL, 0, 0) == 0;
+    }
+    return online_nodes(mask) && syscall(SYS_mbind, addr, size, policy, mask, MAX_NODES + 1, 0) == 0;
+#else
+    (void) addr;
+    (void) size;
+    (void) policy;
+    return 0;
+#endif
+}
+
+int *alloc_array(size_t count, enum alloc_mode mode) {
+    size_t size = sizeof(int) * count;
+    void *p = NULL;
+    switch (mode) {
+    case alloc_malloc:
+        return malloc(size);
+    case alloc_thp:
+        if (posix_memalign(&p, HUGE_PAGE_SIZE, round_up(size, HUGE_PAGE_SIZE)) != 0) {
+            return NULL;
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(p, round_up(size, HUGE_PAGE_SIZE), MADV_HUGEPAGE); /* only a hint, so failure is fine */
+#endif
+        return p;
+    case alloc_hugetlb:
+#ifdef MAP_HUGETLB
+        p = mmap(NULL, round_up(size, HUGE_PAGE_SIZE), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        return p == MAP_FAILED ? NULL : p;
+#else
+        return NULL;
+#endif
+    case alloc_local:
+    case alloc_interleave:
+        p = mmap(NULL, round_up(size, PAGE_SIZE), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            return NULL;
+        }
+        if (!bind_memory(p, round_up(size, PAGE_SIZE), mode == alloc_local ? MPOL_LOCAL : MPOL_INTERLEAVE)) {
+            munmap(p, round_up(size, PAGE_SIZE));
+            return NULL;
+        }
+        /* fault the pages in now, so that they are placed by the policy and not during the benchmark */
+        memset(p, 0, size);
+        return p;
+    default:
+        return NULL;
+    }
+}
+
+void free_array(int *arr, size_t count, enum alloc_mode mode) {
+    size_t size = sizeof(int) * count;
+    if (arr == NULL) {
+        return;
+    }
+    switch (mode) {
+    case alloc_hugetlb:
+        munmap(arr, round_up(size, HUGE_PAGE_SIZE));
+        break;
+    case alloc_local:
+    case alloc_interleave:
+        munmap(arr, round_up(size, PAGE_SIZE));
+        break;
+    default:
+        free(arr);
+        break;
+    }
+}
+
+int pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
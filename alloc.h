@@ -0,0 +1,26 @@
+#ifndef SELECTION_BENCHMARK_ALLOC_H
+#define SELECTION_BENCHMARK_ALLOC_H
+
+#include <stddef.h>
+
+/* How the benchmark arrays are allocated. Large arrays can spend a noticeable part of a partition pass on
+ * TLB misses or on memory attached to another NUMA node, so these make that cost visible. */
+enum alloc_mode {
+    alloc_malloc = 0,  /* plain malloc() */
+    alloc_thp,         /* 2 MiB aligned, with madvise(MADV_HUGEPAGE) for transparent huge pages */
+    alloc_hugetlb,     /* mmap(MAP_HUGETLB), which needs huge pages reserved in /proc/sys/vm/nr_hugepages */
+    alloc_local,       /* pages bound to the local node and touched right away by the calling thread */
+    alloc_interleave,  /* pages interleaved over all online nodes */
+    alloc_mode_end
+};
+
+extern const char *alloc_mode_names[alloc_mode_end];
+
+/* Returns NULL if the memory could not be allocated in the given mode. */
+int *alloc_array(size_t count, enum alloc_mode mode);
+void free_array(int *arr, size_t count, enum alloc_mode mode);
+
+/* Pins the calling thread (and any process it forks later) to one CPU. Returns 0 if that failed. */
+int pin_to_cpu(int cpu);
+
+#endif //SELECTION_BENCHMARK_ALLOC_H
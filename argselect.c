@@ -0,0 +1,134 @@
+#include "argselect.h"
+#include "select.h"
+#include "util.h"
+
+static void swap(int *a, int *b) {
+    int tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void swap64(uint64_t *a, uint64_t *b) {
+    uint64_t tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/* indirect variant: the elements are row ids, ordered by keys[row] */
+
+static void partial_shuffle_idx(int *idx, int from, int to, int sample_last) {
+    for (int i = from; i < to; i++) {
+        int r = (int) (randint() % (sample_last - i));
+        swap(&idx[i], &idx[r + i]);
+    }
+}
+
+static void insertion_sort_idx(const int *keys, int *idx, int from, int to) {
+    for (int i = from + 1; i < to; i++) {
+        int tmp = idx[i], key = keys[tmp], j;
+        for (j = i - 1; j >= from && keys[idx[j]] > key; j--) {
+            idx[j + 1] = idx[j];
+        }
+        idx[j + 1] = tmp;
+    }
+}
+
+static int partition_idx(const int *keys, int *idx, int from, int to, int pivot_loc) {
+    /* same hoare partition as select.c, with the pivot moved to the front */
+    swap(&idx[from], &idx[pivot_loc]);
+    int pivot = keys[idx[from]];
+    int i = from - 1, j = to;
+    while (1) {
+        do {
+            ++i;
+        } while (keys[idx[i]] < pivot);
+        do {
+            --j;
+        } while (keys[idx[j]] > pivot);
+        if (i >= j) {
+            return j + 1;
+        }
+        swap(&idx[i], &idx[j]);
+    }
+}
+
+int argselect(const int *keys, int *idx, int from, int to, int k) {
+    while (to - from > INSERTION_SORT_THRESHOLD) {
+        int len;
+        int sel = from + sampling_rank(from, to, k, &len);
+        partial_shuffle_idx(idx, from, from + len, to);
+        argselect(keys, idx, from, from + len, sel);
+
+        int p = partition_idx(keys, idx, from, to, sel);
+        if (k >= p) {
+            from = p;
+        } else {
+            to = p;
+        }
+    }
+    insertion_sort_idx(keys, idx, from, to);
+    return idx[k];
+}
+
+/* packed variant: the key is stored in the upper half with its sign bit flipped, so that the
+ * unsigned order of the words matches the signed order of the keys */
+
+void pack_keys(const int *keys, uint64_t *packed, int n) {
+    for (int i = 0; i < n; i++) {
+        packed[i] = (uint64_t) ((uint32_t) keys[i] ^ 0x80000000u) << 32 | (uint32_t) i;
+    }
+}
+
+static void partial_shuffle_packed(uint64_t *packed, int from, int to, int sample_last) {
+    for (int i = from; i < to; i++) {
+        int r = (int) (randint() % (sample_last - i));
+        swap64(&packed[i], &packed[r + i]);
+    }
+}
+
+static void insertion_sort_packed(uint64_t *packed, int from, int to) {
+    for (int i = from + 1; i < to; i++) {
+        uint64_t tmp = packed[i];
+        int j;
+        for (j = i - 1; j >= from && packed[j] > tmp; j--) {
+            packed[j + 1] = packed[j];
+        }
+        packed[j + 1] = tmp;
+    }
+}
+
+static int partition_packed(uint64_t *packed, int from, int to, int pivot_loc) {
+    swap64(&packed[from], &packed[pivot_loc]);
+    uint64_t pivot = packed[from];
+    int i = from - 1, j = to;
+    while (1) {
+        do {
+            ++i;
+        } while (packed[i] < pivot);
+        do {
+            --j;
+        } while (packed[j] > pivot);
+        if (i >= j) {
+            return j + 1;
+        }
+        swap64(&packed[i], &packed[j]);
+    }
+}
+
+int argselect_packed(uint64_t *packed, int from, int to, int k) {
+    while (to - from > INSERTION_SORT_THRESHOLD) {
+        int len;
+        int sel = from + sampling_rank(from, to, k, &len);
+        partial_shuffle_packed(packed, from, from + len, to);
+        argselect_packed(packed, from, from + len, sel);
+
+        int p = partition_packed(packed, from, to, sel);
+        if (k >= p) {
+            from = p;
+        } else {
+            to = p;
+        }
+    }
+    insertion_sort_packed(packed, from, to);
+    return (int) (uint32_t) packed[k];
+}
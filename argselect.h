@@ -0,0 +1,18 @@
+#ifndef SELECTION_BENCHMARK_ARGSELECT_H
+#define SELECTION_BENCHMARK_ARGSELECT_H
+
+#include <stdint.h>
+
+/* Selection that finds the row holding the k-th smallest key without moving the keys (or any payload
+ * stored alongside them). Both variants follow the pivot strategy of sampling_pivot(). */
+
+/* Permutes the row ids idx[from..to) so that idx[k] is the row of the k-th smallest key, and returns it.
+ * Every comparison gathers keys[idx[i]], so this is cache-unfriendly once idx is shuffled. */
+int argselect(const int *keys, int *idx, int from, int to, int k);
+
+/* Packs each key with its row id into a 64-bit word that orders by key first. */
+void pack_keys(const int *keys, uint64_t *packed, int n);
+/* Like argselect(), but on words produced by pack_keys(), which keeps the partitioning sequential. */
+int argselect_packed(uint64_t *packed, int from, int to, int k);
+
+#endif //SELECTION_BENCHMARK_ARGSELECT_H
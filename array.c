@@ -92,6 +92,40 @@ void selection_sort(int *arr, int from, int to) {
     }
 }
 
+void fill_array(int *arr, int n, enum array_type type, int m) {
+    switch (type) {
+    case ascending:
+        fill_sequence(arr, 0, n, 0, m, n);
+        break;
+    case shuffled:
+        fill_sequence(arr, 0, n, 0, m, n);
+        shuffle(arr, 0, n);
+        break;
+    case uniform:
+        fill_random(arr, 0, n, 0, m);
+        break;
+    case rotated:
+        fill_sequence(arr, 0, n - m, m, 1, n);
+        fill_sequence(arr, n - m, n, 0, 1, n);
+        break;
+    case nearly_sorted:
+        fill_sequence(arr, 0, n, 0, 1, n);
+        swap_random(arr, 0, n, m);
+        break;
+    case pyramid:
+        fill_pyramid(arr, 0, n, m);
+        shuffle(arr, 0, n);
+        break;
+    case many_duplicates:
+        fill_sequence(arr, 0, n, 0, 1, n);
+        fill_sequence(arr, 0, m, 0, 0, 1);
+        shuffle(arr, 0, n);
+        break;
+    default:
+        break;
+    }
+}
+
 void print_arr(const int *arr, int from, int to) {
     for (int i = from; i < to; i++) {
         printf("%d", arr[i]);
@@ -1,6 +1,20 @@
 #ifndef DETERMINISTIC_SELECT_ARRAY_H
 #define DETERMINISTIC_SELECT_ARRAY_H
 
+enum array_type {
+    ascending = 0,
+    shuffled,
+    uniform,
+    rotated,
+    nearly_sorted,
+    pyramid,
+    many_duplicates,
+    array_type_end
+};
+
+/* fills arr[0..n) with an array of the given type; m is the type-specific modifier */
+void fill_array(int *arr, int n, enum array_type type, int m);
+
 void fill_random(int *arr, int from, int to, int min, int max);
 void fill_sequence(int *arr, int from, int to, int first, int step, int modulo);
 /* fills array with 1, 2, 2, 3, 3, 3, 4, 4, 4, 4, ... */
@@ -0,0 +1,100 @@
+#include "batch.h"
+#include "select.h"
+#include "array.h"
+#include "util.h"
+
+#include <limits.h>
+
+static int med3(int a, int b, int c) {
+    return a >= b ? b >= c ? b : a >= c ? c : a :
+           c >= b ? b : a >= c ? a : c;
+}
+
+/* n^(2/3) and (n^(2/3))^(1/2) for n = 2^b, indexed by the bit length b of the segment length */
+static const int sample_sizes[] = {1, 1, 2, 4, 6, 10, 16, 25, 40, 64, 102, 161, 256};
+static const int sample_bias[] = {0, 1, 1, 2, 2, 3, 4, 5, 6, 8, 10, 13, 16};
+
+/* sampling_pivot() with the sample size and the bias towards the middle taken from a table,
+ * which is accurate enough for short segments and avoids pow() and sqrt() */
+int cheap_sampling_pivot(int *arr, int from, int to, int k) {
+    int len = to - from, b = 0;
+    if (len <= INSERTION_SORT_THRESHOLD) {
+        return random_pivot(arr, from, to, k);
+    }
+    while (b < 12 && (2 << b) <= len) {
+        b++;
+    }
+    int s = sample_sizes[b], d = sample_bias[b];
+    int loc = (int) ((long long) (k - from) * s / len);
+    int sel = med3(0, med3(loc + d, s / 2, loc - d), s - 1);
+
+    partial_shuffle(arr, from, from + s, to);
+    select(arr, from, from + s, from + sel, cheap_sampling_pivot, 0);
+
+    return from + sel;
+}
+
+static void compare_exchange(int lanes[][BATCH_LANES], int i, int j) {
+    /* written without branches so that the compiler can vectorize across the lanes */
+    for (int l = 0; l < BATCH_LANES; l++) {
+        int a = lanes[i][l], b = lanes[j][l];
+        lanes[i][l] = a < b ? a : b;
+        lanes[j][l] = a < b ? b : a;
+    }
+}
+
+/* batcher's odd-even merge sort over the rows lanes[0..n) */
+static void sorting_network(int lanes[][BATCH_LANES], int n) {
+    for (int p = 1; p < n; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+            for (int j = k % p; j + k < n; j += 2 * k) {
+                for (int i = 0; i < k && i + j + k < n; i++) {
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+                        compare_exchange(lanes, i + j, i + j + k);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* selects from up to BATCH_LANES tiny segments at once; shorter segments are padded with INT_MAX,
+ * which sorts after every real element and so does not change the ranks */
+static void select_lanes(const int *arr, const int *offsets, const int *ks, int count, int *results) {
+    int lanes[BATCH_NETWORK_MAX][BATCH_LANES];
+    int n = 0;
+    for (int l = 0; l < count; l++) {
+        n = MAX(n, offsets[l + 1] - offsets[l]);
+    }
+    for (int l = 0; l < BATCH_LANES; l++) {
+        int from = l < count ? offsets[l] : 0, len = l < count ? offsets[l + 1] - from : 0;
+        for (int i = 0; i < n; i++) {
+            lanes[i][l] = i < len ? arr[from + i] : INT_MAX;
+        }
+    }
+    sorting_network(lanes, n);
+    for (int l = 0; l < count; l++) {
+        results[l] = lanes[ks[l]][l];
+    }
+}
+
+void select_batch(int *arr, const int *offsets, const int *ks, int count, int *results) {
+    int i = 0;
+    while (i < count) {
+        int lanes = 0;
+        while (lanes < BATCH_LANES && i + lanes < count &&
+               offsets[i + lanes + 1] - offsets[i + lanes] <= BATCH_NETWORK_MAX) {
+            lanes++;
+        }
+        if (lanes > 1) {
+            select_lanes(arr, &offsets[i], &ks[i], lanes, &results[i]);
+            i += lanes;
+            continue;
+        }
+
+        int from = offsets[i], to = offsets[i + 1];
+        choose_pivot strategy = to - from <= BATCH_CHEAP_PIVOT_MAX ? cheap_sampling_pivot : sampling_pivot;
+        results[i] = select(arr, from, to, from + ks[i], strategy, 0);
+        i++;
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef SELECTION_BENCHMARK_BATCH_H
+#define SELECTION_BENCHMARK_BATCH_H
+
+/* segments up to this length are sorted together with a sorting network, one segment per lane */
+#define BATCH_NETWORK_MAX 64
+#define BATCH_LANES 8
+/* segments up to this length use a pivot strategy without floating-point math */
+#define BATCH_CHEAP_PIVOT_MAX 4096
+
+/* Finds the ks[i]-th smallest element of the segment arr[offsets[i]..offsets[i + 1]) for each of the
+ * count segments and stores it in results[i]. ks[i] is relative to the start of its segment.
+ * Segments may be permuted, as with select(). */
+void select_batch(int *arr, const int *offsets, const int *ks, int count, int *results);
+
+int cheap_sampling_pivot(int *arr, int from, int to, int k);
+
+#endif //SELECTION_BENCHMARK_BATCH_H
@@ -0,0 +1,830 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "util.h"
+#include "select_index.h"
+#include "topk.h"
+#include "argselect.h"
+#include "batch.h"
+#include "window.h"
+#include "select_readonly.h"
+#include "distributed.h"
+#include "select_cpp.h"
+
+choose_pivot pivots[PIVOT_ALG_COUNT] = {
+//    first_pivot,
+    random_pivot,
+//    med3_pivot,
+    ninther_pivot,
+    deterministic_pivot,
+//    deterministic_adaptive_pivot,
+//    deterministic_strided_pivot,
+    deterministic_adaptive_strided_pivot,
+    sampling_pivot
+};
+
+const char *alg_names[ALG_COUNT] = {
+//    "First",
+    "Random",
+//    "Median of 3",
+    "Ninther",
+    "BFPRT",
+//    "BFPRTA",
+//    "BFPRT+",
+    "BFPRTA+",
+    "Sampling",
+    "libstdc++",
+};
+
+int do_select(int *arr, int size, int k, int alg, int record) {
+    if (alg < PIVOT_ALG_COUNT) {
+        return select(arr, 0, size, k, pivots[alg], record);
+    } else {
+        return select_cpp(arr, 0, size, k);
+    }
+}
+
+static float elapsed_ms(clock_t start, clock_t end) {
+    return (float) (end - start) * 1000.f / CLOCKS_PER_SEC;
+}
+
+/* averages the reps of each row, dropping the min and max like the default benchmark does */
+static float trimmed_mean(const float *values, int count) {
+    float sum = 0.f, lo = values[0], hi = values[0];
+    for (int i = 0; i < count; i++) {
+        sum += values[i];
+        lo = MIN(lo, values[i]);
+        hi = MAX(hi, values[i]);
+    }
+    return count < 3 ? sum / (float) count : (sum - lo - hi) / (float) (count - 2);
+}
+
+/* the k of the given row in the k/L tables, following the default benchmark */
+static int target_k(const struct bench_config *cfg, int row) {
+    if (cfg->fixed_k >= 0) {
+        return cfg->fixed_k;
+    }
+    return cfg->iterations < 2 ? 0 : (int) ((long long) (cfg->n - 1) * row / (cfg->iterations - 1));
+}
+
+static int checkpoint_count(int queries) {
+    int count = 1;
+    for (long long q = 1; q < queries; q *= 2) {
+        count++;
+    }
+    return count;
+}
+
+void bench_index(const struct bench_config *cfg, int *arr) {
+    int n = cfg->n, r = cfg->r;
+    int rows = checkpoint_count(cfg->queries);
+    int *ranks = malloc(sizeof(int) * cfg->queries);
+    /* column 2 * i is plain select, column 2 * i + 1 is indexed; values are per rep */
+    float *times = malloc(sizeof(float) * 2 * ALG_COUNT * rows * r);
+    if (ranks == NULL || times == NULL) {
+        fprintf(stderr, "Array allocation failed.\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < ALG_COUNT; i++) {
+        if ((cfg->alg_mask & (1 << i)) == 0) {
+            continue;
+        }
+        for (int indexed = 0; indexed < (i < PIVOT_ALG_COUNT ? 2 : 1); indexed++) {
+            for (int k = 0; k < r; k++) {
+                struct select_index idx;
+                float time_sum = 0.f;
+                int row = 0;
+                long long next_checkpoint = 1;
+
+                fprintf(stderr, "\r%s%s: (%2d/%2d)", alg_names[i], indexed ? " (indexed)" : "", k + 1, r);
+
+                seed(k + 1);
+                fill_array(arr, n, cfg->type, cfg->m);
+                for (int q = 0; q < cfg->queries; q++) {
+                    ranks[q] = (int) (randint() % n);
+                }
+                select_index_init(&idx, arr, n);
+
+                /* time the queries between two checkpoints together, so that clock() resolution
+                 * does not dominate when a single query is cheap */
+                for (int q = 0; q < cfg->queries; q = (int) next_checkpoint, next_checkpoint *= 2) {
+                    int res = 0, last = (int) MIN(next_checkpoint, cfg->queries);
+                    clock_t start = clock();
+                    for (int j = q; j < last; j++) {
+                        res = indexed ? select_index_query(&idx, ranks[j], pivots[i]) :
+                                        do_select(arr, n, ranks[j], i, 0);
+                    }
+                    clock_t end = clock();
+                    time_sum += elapsed_ms(start, end);
+                    times[((2 * i + indexed) * rows + row++) * r + k] = time_sum / (float) last;
+
+                    if (!check_select(arr, 0, n, ranks[last - 1], res)) {
+                        fprintf(stderr, "Algorithm %s is incorrect!\n", alg_names[i]);
+                    }
+                }
+                select_index_free(&idx);
+            }
+        }
+        fprintf(stderr, " OK\n");
+    }
+
+    if (cfg->print == all) {
+        printf("\namortized time per query (ms)\n");
+    }
+    printf("queries");
+    for (int i = 0; i < ALG_COUNT; i++) {
+        if ((cfg->alg_mask & (1 << i)) == 0) {
+            continue;
+        }
+        printf(",%s", alg_names[i]);
+        if (i < PIVOT_ALG_COUNT) {
+            printf(",%s (indexed)", alg_names[i]);
+        }
+    }
+    printf("\n");
+    for (int row = 0; row < rows; row++) {
+        printf("%d", (int) MIN(1LL << row, cfg->queries));
+        for (int i = 0; i < ALG_COUNT; i++) {
+            if ((cfg->alg_mask & (1 << i)) == 0) {
+                continue;
+            }
+            for (int indexed = 0; indexed < (i < PIVOT_ALG_COUNT ? 2 : 1); indexed++) {
+                printf(",%.5f", trimmed_mean(&times[((2 * i + indexed) * rows + row) * r], r));
+            }
+        }
+        printf("\n");
+    }
+
+    free(ranks);
+    free(times);
+}
+
+enum topk_method {
+    topk_heap = PIVOT_ALG_COUNT,
+    topk_partial_sort,
+    topk_nth_element,
+    topk_method_end
+};
+
+static const char *topk_method_names[] = {
+    "Heap",
+    "std::partial_sort",
+    "std::nth_element+sort"
+};
+
+static int topk_enabled(int alg_mask, int method) {
+    if (method < PIVOT_ALG_COUNT) {
+        return (alg_mask & (1 << method)) != 0;
+    }
+    /* the standard library variants are toggled together with libstdc++ */
+    return method == topk_heap || (alg_mask & (1 << PIVOT_ALG_COUNT)) != 0;
+}
+
+static void do_topk(int *arr, int n, int k, int method) {
+    switch (method) {
+    case topk_heap:
+        top_k_heap(arr, 0, n, k);
+        break;
+    case topk_partial_sort:
+        partial_sort_cpp(arr, 0, n, k);
+        break;
+    case topk_nth_element:
+        nth_element_sort_cpp(arr, 0, n, k);
+        break;
+    default:
+        top_k_select(arr, 0, n, k, pivots[method]);
+        break;
+    }
+}
+
+static int check_topk(const int *arr, int n, int k) {
+    if (k == 0) {
+        return 1; /* there is nothing to check */
+    }
+    for (int i = 1; i < k; i++) {
+        if (arr[i - 1] > arr[i]) {
+            return 0;
+        }
+    }
+    return check_select(arr, 0, n, k - 1, arr[k - 1]);
+}
+
+void bench_topk(const struct bench_config *cfg, int *arr) {
+    int n = cfg->n, r = cfg->r;
+    int rows = cfg->fixed_k < 0 ? checkpoint_count(n) : 1;
+    float *times = malloc(sizeof(float) * topk_method_end * rows * r);
+    if (times == NULL) {
+        fprintf(stderr, "Array allocation failed.\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < topk_method_end; i++) {
+        const char *name = i < PIVOT_ALG_COUNT ? alg_names[i] : topk_method_names[i - PIVOT_ALG_COUNT];
+        if (!topk_enabled(cfg->alg_mask, i)) {
+            continue;
+        }
+        for (int row = 0; row < rows; row++) {
+            int k = cfg->fixed_k < 0 ? (int) MIN(1LL << row, n) : cfg->fixed_k;
+            for (int j = 0; j < r; j++) {
+                fprintf(stderr, "\r%s: k = %9d (%2d/%2d)", name, k, j + 1, r);
+
+                seed(j + 1);
+                fill_array(arr, n, cfg->type, cfg->m);
+                int checksum = xor_sum(arr, 0, n);
+
+                clock_t start = clock();
+                do_topk(arr, n, k, i);
+                clock_t end = clock();
+                times[(i * rows + row) * r + j] = elapsed_ms(start, end);
+
+                if (!check_topk(arr, n, k) || checksum != xor_sum(arr, 0, n)) {
+                    fprintf(stderr, "Algorithm %s is incorrect!\n", name);
+                }
+            }
+        }
+        fprintf(stderr, " OK\n");
+    }
+
+    if (cfg->print == all) {
+        printf("\ntop-k times (ms)\n");
+    }
+    printf("k");
+    for (int i = 0; i < topk_method_end; i++) {
+        if (topk_enabled(cfg->alg_mask, i)) {
+            printf(",%s", i < PIVOT_ALG_COUNT ? alg_names[i] : topk_method_names[i - PIVOT_ALG_COUNT]);
+        }
+    }
+    printf("\n");
+    for (int row = 0; row < rows; row++) {
+        printf("%d", cfg->fixed_k < 0 ? (int) MIN(1LL << row, n) : cfg->fixed_k);
+        for (int i = 0; i < topk_method_end; i++) {
+            if (topk_enabled(cfg->alg_mask, i)) {
+                printf(",%.5f", trimmed_mean(&times[(i * rows + row) * r], r));
+            }
+        }
+        printf("\n");
+    }
+
+    free(times);
+}
+
+enum argselect_method {
+    arg_indirect = 0,
+    arg_indirect_shuffled,
+    arg_packed,
+    argselect_method_end
+};
+
+static const char *argselect_method_names[] = {
+    "Indirect",
+    "Indirect (shuffled rows)",
+    "Packed"
+};
+
+void bench_argselect(const struct bench_config *cfg, int *arr) {
+    int n = cfg->n, r = cfg->r;
+    int rows = cfg->fixed_k < 0 ? cfg->iterations : 1;
+    /* column c < ALG_COUNT selects the keys directly with algorithm c, the rest are the argselect methods */
+    int cols = ALG_COUNT + argselect_method_end;
+    int *idx = malloc(sizeof(int) * n);
+    int *shuffled = malloc(sizeof(int) * n);
+    uint64_t *packed = malloc(sizeof(uint64_t) * n);
+    float *times = malloc(sizeof(float) * cols * rows * r);
+    if (idx == NULL || shuffled == NULL || packed == NULL || times == NULL) {
+        fprintf(stderr, "Array allocation failed.\n");
+        exit(1);
+    }
+
+    for (int c = 0; c < cols; c++) {
+        if (c < ALG_COUNT && (cfg->alg_mask & (1 << c)) == 0) {
+            continue;
+        }
+        const char *name = c < ALG_COUNT ? alg_names[c] : argselect_method_names[c - ALG_COUNT];
+        for (int row = 0; row < rows; row++) {
+            int k = target_k(cfg, row);
+            for (int j = 0; j < r; j++) {
+                int res;
+                fprintf(stderr, "\r%s: %3d/%3d (%2d/%2d)", name, row, rows - 1, j + 1, r);
+
+                seed(cfg->fixed_k < 0 ? j + 1 : row + 1);
+                fill_array(arr, n, cfg->type, cfg->m);
+                int checksum = xor_sum(arr, 0, n);
+                if (c == ALG_COUNT + arg_indirect_shuffled) {
+                    fill_sequence(shuffled, 0, n, 0, 1, 0);
+                    shuffle(shuffled, 0, n);
+                }
+
+                /* building the index or packed words is part of the cost of each method: both indirect methods
+                 * write n row ids, only in a different order */
+                clock_t start = clock();
+                switch (c - ALG_COUNT) {
+                case arg_indirect:
+                    fill_sequence(idx, 0, n, 0, 1, 0);
+                    res = arr[argselect(arr, idx, 0, n, k)];
+                    break;
+                case arg_indirect_shuffled:
+                    memcpy(idx, shuffled, sizeof(int) * n);
+                    res = arr[argselect(arr, idx, 0, n, k)];
+                    break;
+                case arg_packed:
+                    pack_keys(arr, packed, n);
+                    res = arr[argselect_packed(packed, 0, n, k)];
+                    break;
+                default:
+                    res = do_select(arr, n, k, c, 0);
+                    break;
+                }
+                clock_t end = clock();
+                times[(c * rows + row) * r + j] = elapsed_ms(start, end);
+
+                if (!check_select(arr, 0, n, k, res) || checksum != xor_sum(arr, 0, n)) {
+                    fprintf(stderr, "Algorithm %s is incorrect!\n", name);
+                }
+            }
+        }
+        fprintf(stderr, " OK\n");
+    }
+
+    if (cfg->print == all) {
+        printf("\nargselect times (ms)\n");
+    }
+    printf("k/L");
+    for (int c = 0; c < cols; c++) {
+        if (c < ALG_COUNT && (cfg->alg_mask & (1 << c)) == 0) {
+            continue;
+        }
+        printf(",%s", c < ALG_COUNT ? alg_names[c] : argselect_method_names[c - ALG_COUNT]);
+    }
+    printf("\n");
+    for (int row = 0; row < rows; row++) {
+        printf("%g", cfg->fixed_k < 0 ? (float) row / (float) MAX(cfg->iterations - 1, 1) : (float) cfg->fixed_k / n);
+        for (int c = 0; c < cols; c++) {
+            if (c < ALG_COUNT && (cfg->alg_mask & (1 << c)) == 0) {
+                continue;
+            }
+            printf(",%.5f", trimmed_mean(&times[(c * rows + row) * r], r));
+        }
+        printf("\n");
+    }
+
+    free(idx);
+    free(shuffled);
+    free(packed);
+    free(times);
+}
+
+#define BATCH_MIN_LENGTH 16
+#define BATCH_MAX_LENGTH 4096
+
+/* cuts arr[0..n) into segments; a row with max_len = L has lengths in (L / 2, L], except for the
+ * last row (max_len = 0), which mixes lengths from BATCH_MIN_LENGTH to BATCH_MAX_LENGTH log-uniformly */
+static int make_segments(int n, int max_len, int *offsets, int *ks) {
+    int count = 0, pos = 0;
+    while (pos < n) {
+        int len;
+        if (max_len > 0) {
+            len = max_len / 2 + 1 + (int) (randint() % (max_len - max_len / 2));
+        } else {
+            int b = 4 + (int) (randint() % 8); /* 2^4 = BATCH_MIN_LENGTH, 2^12 = BATCH_MAX_LENGTH */
+            len = (1 << b) + (int) (randint() % (1 << b));
+            len = MIN(len, BATCH_MAX_LENGTH);
+        }
+        len = MIN(len, n - pos);
+        offsets[count] = pos;
+        ks[count] = len / 2;
+        pos += len;
+        count++;
+    }
+    offsets[count] = n;
+    return count;
+}
+
+void bench_batch(const struct bench_config *cfg, int *arr) {
+    int n = cfg->n, r = cfg->r;
+    int rows = 0;
+    for (int len = BATCH_MIN_LENGTH; len <= BATCH_MAX_LENGTH; len *= 2) {
+        rows++;
+    }
+    rows++; /* mixed lengths */
+    int cols = 1 + ALG_COUNT;
+    int *offsets = malloc(sizeof(int) * (n + 1));
+    int *ks = malloc(sizeof(int) * n);
+    int *results = malloc(sizeof(int) * n);
+    float *times = malloc(sizeof(float) * cols * rows * r);
+    if (offsets == NULL || ks == NULL || results == NULL || times == NULL) {
+        fprintf(stderr, "Array allocation failed.\n");
+        exit(1);
+    }
+
+    /* column 0 is select_batch(), column i + 1 is algorithm i called once per segment */
+    for (int c = 0; c < cols; c++) {
+        const char *name = c == 0 ? "Batch" : alg_names[c - 1];
+        if (c > 0 && (cfg->alg_mask & (1 << (c - 1))) == 0) {
+            continue;
+        }
+        for (int row = 0; row < rows; row++) {
+            int max_len = row < rows - 1 ? BATCH_MIN_LENGTH << row : 0;
+            for (int j = 0; j < r; j++) {
+                fprintf(stderr, "\r%s: %3d/%3d (%2d/%2d)", name, row, rows - 1, j + 1, r);
+
+                seed(j + 1);
+                fill_array(arr, n, cfg->type, cfg->m);
+                int count = make_segments(n, max_len, offsets, ks);
+
+                clock_t start = clock();
+                if (c == 0) {
+                    select_batch(arr, offsets, ks, count, results);
+                } else {
+                    for (int i = 0; i < count; i++) {
+                        results[i] = c - 1 < PIVOT_ALG_COUNT ?
+                                     select(arr, offsets[i], offsets[i + 1], offsets[i] + ks[i], pivots[c - 1], 0) :
+                                     select_cpp(arr, offsets[i], offsets[i + 1], offsets[i] + ks[i]);
+                    }
+                }
+                clock_t end = clock();
+                /* each rep cuts the array differently, so its time is divided by its own number of segments */
+                times[(c * rows + row) * r + j] = elapsed_ms(start, end) / (float) count;
+
+                for (int i = 0; i < count; i++) {
+                    if (!check_select(arr, offsets[i], offsets[i + 1], offsets[i] + ks[i], results[i])) {
+                        fprintf(stderr, "Algorithm %s is incorrect!\n", name);
+                        break;
+                    }
+                }
+            }
+        }
+        fprintf(stderr, " OK\n");
+    }
+
+    if (cfg->print == all) {
+        printf("\nmedians per second\n");
+    }
+    printf("segment length,Batch");
+    for (int i = 0; i < ALG_COUNT; i++) {
+        if ((cfg->alg_mask & (1 << i)) != 0) {
+            printf(",%s", alg_names[i]);
+        }
+    }
+    printf("\n");
+    for (int row = 0; row < rows; row++) {
+        if (row < rows - 1) {
+            printf("%d-%d", (BATCH_MIN_LENGTH << row) / 2 + 1, BATCH_MIN_LENGTH << row);
+        } else {
+            printf("%d-%d", BATCH_MIN_LENGTH, BATCH_MAX_LENGTH);
+        }
+        for (int c = 0; c < cols; c++) {
+            if (c > 0 && (cfg->alg_mask & (1 << (c - 1))) == 0) {
+                continue;
+            }
+            float ms = trimmed_mean(&times[(c * rows + row) * r], r);
+            printf(",%.0f", 1000.f / MAX(ms, 1E-9f));
+        }
+        printf("\n");
+    }
+
+    free(offsets);
+    free(ks);
+    free(results);
+    free(times);
+}
+
+#define WINDOW_MIN_SIZE 16
+#define WINDOW_MAX_SIZE 65536
+/* recomputing through select() costs O(window) per step, so it only runs for this many elements in total */
+#define WINDOW_RECOMPUTE_WORK (1 << 24)
+
+void bench_window(const struct bench_config *cfg, int *arr) {
+    int n = cfg->n, r = cfg->r;
+    int rows = 0;
+    for (int size = WINDOW_MIN_SIZE; size <= MIN(n, WINDOW_MAX_SIZE); size *= 4) {
+        rows++;
+    }
+    if (cfg->window > 0 || rows == 0) {
+        rows = 1;
+    }
+    int cols = 1 + ALG_COUNT;
+    int *expected = malloc(sizeof(int) * n);
+    int *scratch = malloc(sizeof(int) * (cfg->window > 0 ? cfg->window : MIN(n, WINDOW_MAX_SIZE)));
+    float *times = malloc(sizeof(float) * cols * rows * r);
+    int *steps = malloc(sizeof(int) * cols * rows);
+    if (expected == NULL || scratch == NULL || times == NULL || steps == NULL) {
+        fprintf(stderr, "Array allocation failed.\n");
+        exit(1);
+    }
+
+    /* column 0 is the sliding window, column i + 1 recomputes each window with algorithm i. Neither
+     * modifies arr, so every column runs on the same array and is checked against the sliding window. */
+    for (int row = 0; row < rows; row++) {
+        int size = cfg->window > 0 ? cfg->window : MIN(WINDOW_MIN_SIZE << (2 * row), n);
+        int k = (int) ((long long) (size - 1) * cfg->quantile / 100);
+
+        for (int j = 0; j < r; j++) {
+            fprintf(stderr, "\rwindow size %9d (%2d/%2d)", size, j + 1, r);
+
+            seed(j + 1);
+            fill_array(arr, n, cfg->type, cfg->m);
+
+            for (int c = 0; c < cols; c++) {
+                if (c > 0 && (cfg->alg_mask & (1 << (c - 1))) == 0) {
+                    continue;
+                }
+                int last = c == 0 ? n : MIN(n, size - 1 + MAX(1, WINDOW_RECOMPUTE_WORK / size));
+                int correct = 1;
+                steps[c * rows + row] = last - (size - 1);
+
+                clock_t start = clock();
+                if (c == 0) {
+                    struct sliding_window w;
+                    if (!sliding_window_init(&w, size)) {
+                        fprintf(stderr, "Array allocation failed.\n");
+                        exit(1);
+                    }
+                    for (int i = 0; i < n; i++) {
+                        sliding_window_push(&w, arr[i]);
+                        if (i >= size - 1) {
+                            expected[i] = sliding_window_rank(&w, k);
+                        }
+                    }
+                    sliding_window_free(&w);
+                } else {
+                    for (int i = size - 1; i < last; i++) {
+                        memcpy(scratch, &arr[i - size + 1], sizeof(int) * size);
+                        int res = c - 1 < PIVOT_ALG_COUNT ? select(scratch, 0, size, k, pivots[c - 1], 0) :
+                                                            select_cpp(scratch, 0, size, k);
+                        correct &= res == expected[i];
+                    }
+                }
+                clock_t end = clock();
+                times[(c * rows + row) * r + j] = elapsed_ms(start, end);
+
+                if (c == 0) {
+                    correct = check_select(arr, last - size, last, last - size + k, expected[last - 1]);
+                }
+                if (!correct) {
+                    fprintf(stderr, "Algorithm %s is incorrect!\n", c == 0 ? "Window" : alg_names[c - 1]);
+                }
+            }
+        }
+    }
+    fprintf(stderr, " OK\n");
+
+    if (cfg->print == all) {
+        printf("\nwindow steps per second (p%d)\n", cfg->quantile);
+    }
+    printf("window size,Window");
+    for (int i = 0; i < ALG_COUNT; i++) {
+        if ((cfg->alg_mask & (1 << i)) != 0) {
+            printf(",%s", alg_names[i]);
+        }
+    }
+    printf("\n");
+    for (int row = 0; row < rows; row++) {
+        printf("%d", cfg->window > 0 ? cfg->window : MIN(WINDOW_MIN_SIZE << (2 * row), n));
+        for (int c = 0; c < cols; c++) {
+            if (c > 0 && (cfg->alg_mask & (1 << (c - 1))) == 0) {
+                continue;
+            }
+            float ms = trimmed_mean(&times[(c * rows + row) * r], r);
+            printf(",%.0f", (float) steps[c * rows + row] * 1000.f / MAX(ms, 1E-6f));
+        }
+        printf("\n");
+    }
+
+    free(expected);
+    free(scratch);
+    free(times);
+    free(steps);
+}
+
+void bench_readonly(const struct bench_config *cfg, int *arr) {
+    int n = cfg->n, r = cfg->r;
+    int rows = cfg->fixed_k < 0 ? cfg->iterations : 1;
+    int *copy = malloc(sizeof(int) * n);
+    float *times = malloc(sizeof(float) * 2 * rows * r);
+    float *peaks = malloc(sizeof(float) * rows);
+    if (copy == NULL || times == NULL || peaks == NULL) {
+        fprintf(stderr, "Array allocation failed.\n");
+        exit(1);
+    }
+
+    /* column 0 copies the array and then selects, column 1 selects without modifying the array */
+    for (int c = 0; c < 2; c++) {
+        struct select_arena arena;
+        select_arena_init(&arena);
+        for (int row = 0; row < rows; row++) {
+            int k = target_k(cfg, row);
+            int peak = 0;
+            for (int j = 0; j < r; j++) {
+                int res;
+                fprintf(stderr, "\r%s: %3d/%3d (%2d/%2d)", c == 0 ? "Copy+select" : "Read-only", row, rows - 1, j + 1, r);
+
+                seed(cfg->fixed_k < 0 ? j + 1 : row + 1);
+                fill_array(arr, n, cfg->type, cfg->m);
+                int checksum = xor_sum(arr, 0, n);
+                /* start every row from an empty arena, so that its peak size is measured per k */
+                if (j == 0) {
+                    select_arena_free(&arena);
+                }
+
+                clock_t start = clock();
+                if (c == 0) {
+                    memcpy(copy, arr, sizeof(int) * n);
+                    res = select(copy, 0, n, k, sampling_pivot, 0);
+                } else if (!select_readonly(arr, 0, n, k, &arena, &res)) {
+                    fprintf(stderr, "Array allocation failed.\n");
+                    exit(1);
+                }
+                clock_t end = clock();
+                times[(c * rows + row) * r + j] = elapsed_ms(start, end);
+                peak = c == 0 ? n : MAX(peak, arena.capacity);
+
+                if (!check_select(arr, 0, n, k, res) || checksum != xor_sum(arr, 0, n)) {
+                    fprintf(stderr, "Algorithm %s is incorrect!\n", c == 0 ? "Copy+select" : "Read-only");
+                }
+            }
+            if (c == 1) {
+                peaks[row] = (float) peak * (float) sizeof(int) / 1024.f;
+            }
+        }
+        select_arena_free(&arena);
+        fprintf(stderr, " OK\n");
+    }
+
+    if (cfg->print == all) {
+        printf("\nnon-destructive selection times (ms) and scratch memory (KiB)\n");
+    }
+    printf("k/L,Copy+select,Read-only,Copy+select memory,Read-only memory\n");
+    for (int row = 0; row < rows; row++) {
+        printf("%g", cfg->fixed_k < 0 ? (float) row / (float) MAX(cfg->iterations - 1, 1) : (float) cfg->fixed_k / n);
+        for (int c = 0; c < 2; c++) {
+            printf(",%.5f", trimmed_mean(&times[(c * rows + row) * r], r));
+        }
+        printf(",%.1f,%.1f\n", (float) n * (float) sizeof(int) / 1024.f, peaks[row]);
+    }
+
+    free(copy);
+    free(times);
+    free(peaks);
+}
+
+/* the distributed selection gathers the candidates once there are at most this many left */
+#define DISTRIBUTED_GATHER_THRESHOLD 16384
+
+enum distributed_column {
+    dist_latency = 0,
+    gather_latency,
+    dist_rounds,
+    dist_bytes,
+    gather_bytes,
+    distributed_column_end
+};
+
+static const char *distributed_column_names[] = {
+    "Distributed (ms)",
+    "Gather+select (ms)",
+    "Distributed rounds",
+    "Distributed bytes",
+    "Gather+select bytes"
+};
+
+void bench_distributed(const struct bench_config *cfg, int *arr) {
+    int n = cfg->n, r = cfg->r;
+    int rows = cfg->fixed_k < 0 ? cfg->iterations : 1;
+    float *values = malloc(sizeof(float) * distributed_column_end * rows * r);
+    if (values == NULL) {
+        fprintf(stderr, "Array allocation failed.\n");
+        exit(1);
+    }
+
+    for (int row = 0; row < rows; row++) {
+        int k = target_k(cfg, row);
+        for (int j = 0; j < r; j++) {
+            struct distributed_stats dist, gather;
+            fprintf(stderr, "\r%d workers: %3d/%3d (%2d/%2d)", cfg->workers, row, rows - 1, j + 1, r);
+
+            seed(cfg->fixed_k < 0 ? j + 1 : row + 1);
+            fill_array(arr, n, cfg->type, cfg->m);
+
+            /* both strategies query the same workers, which reset their candidates for every query */
+            struct shard_cluster *cluster = cluster_start(arr, n, cfg->workers);
+            if (cluster == NULL) {
+                fprintf(stderr, "Could not start the worker processes.\n");
+                exit(1);
+            }
+            int res, expected;
+            int ok = cluster_select(cluster, k, DISTRIBUTED_GATHER_THRESHOLD, &dist, &res) &&
+                     cluster_select(cluster, k, n, &gather, &expected);
+            cluster_stop(cluster);
+            if (!ok) {
+                fprintf(stderr, "Lost contact with the workers.\n");
+                exit(1);
+            }
+
+            if (!check_select(arr, 0, n, k, res) || !check_select(arr, 0, n, k, expected)) {
+                fprintf(stderr, "Distributed selection is incorrect!\n");
+            }
+            values[(dist_latency * rows + row) * r + j] = (float) dist.latency_ms;
+            values[(gather_latency * rows + row) * r + j] = (float) gather.latency_ms;
+            values[(dist_rounds * rows + row) * r + j] = (float) dist.rounds;
+            values[(dist_bytes * rows + row) * r + j] = (float) dist.bytes;
+            values[(gather_bytes * rows + row) * r + j] = (float) gather.bytes;
+        }
+    }
+    fprintf(stderr, " OK\n");
+
+    if (cfg->print == all) {
+        printf("\ndistributed selection over %d workers\n", cfg->workers);
+    }
+    printf("k/L");
+    for (int c = 0; c < distributed_column_end; c++) {
+        printf(",%s", distributed_column_names[c]);
+    }
+    printf("\n");
+    for (int row = 0; row < rows; row++) {
+        printf("%g", cfg->fixed_k < 0 ? (float) row / (float) MAX(cfg->iterations - 1, 1) : (float) cfg->fixed_k / n);
+        for (int c = 0; c < distributed_column_end; c++) {
+            printf(c < dist_rounds ? ",%.5f" : ",%.0f", trimmed_mean(&values[(c * rows + row) * r], r));
+        }
+        printf("\n");
+    }
+
+    free(values);
+}
+
+void bench_alloc(const struct bench_config *cfg) {
+    int n = cfg->n, r = cfg->r;
+    int rows = cfg->fixed_k < 0 ? cfg->iterations : 1;
+    int available[alloc_mode_end];
+    float *times = malloc(sizeof(float) * alloc_mode_end * ALG_COUNT * rows * r);
+    if (times == NULL) {
+        fprintf(stderr, "Array allocation failed.\n");
+        exit(1);
+    }
+
+    /* allocate one mode at a time, since the arrays may be too large to hold several at once */
+    for (int a = 0; a < alloc_mode_end; a++) {
+        int *arr = alloc_array(n, a);
+        available[a] = arr != NULL;
+        if (arr == NULL) {
+            fprintf(stderr, "Allocation mode %s is not available here, skipping it.\n", alloc_mode_names[a]);
+            continue;
+        }
+        for (int i = 0; i < ALG_COUNT; i++) {
+            if ((cfg->alg_mask & (1 << i)) == 0) {
+                continue;
+            }
+            for (int row = 0; row < rows; row++) {
+                int k = target_k(cfg, row);
+                for (int j = 0; j < r; j++) {
+                    fprintf(stderr, "\r%s (%s): %3d/%3d (%2d/%2d)", alg_names[i], alloc_mode_names[a],
+                            row, rows - 1, j + 1, r);
+
+                    seed(cfg->fixed_k < 0 ? j + 1 : row + 1);
+                    fill_array(arr, n, cfg->type, cfg->m);
+
+                    clock_t start = clock();
+                    int res = do_select(arr, n, k, i, 0);
+                    clock_t end = clock();
+                    times[((a * ALG_COUNT + i) * rows + row) * r + j] = elapsed_ms(start, end);
+
+                    if (!check_select(arr, 0, n, k, res)) {
+                        fprintf(stderr, "Algorithm %s is incorrect!\n", alg_names[i]);
+                    }
+                }
+            }
+            fprintf(stderr, " OK\n");
+        }
+        free_array(arr, n, a);
+    }
+
+    if (cfg->print == all) {
+        printf("\ntimes by allocation mode (ms)\n");
+    }
+    printf("k/L");
+    for (int i = 0; i < ALG_COUNT; i++) {
+        for (int a = 0; a < alloc_mode_end; a++) {
+            if ((cfg->alg_mask & (1 << i)) != 0 && available[a]) {
+                printf(",%s (%s)", alg_names[i], alloc_mode_names[a]);
+            }
+        }
+    }
+    printf("\n");
+    for (int row = 0; row < rows; row++) {
+        printf("%g", cfg->fixed_k < 0 ? (float) row / (float) MAX(cfg->iterations - 1, 1) : (float) cfg->fixed_k / n);
+        for (int i = 0; i < ALG_COUNT; i++) {
+            for (int a = 0; a < alloc_mode_end; a++) {
+                if ((cfg->alg_mask & (1 << i)) != 0 && available[a]) {
+                    printf(",%.5f", trimmed_mean(&times[((a * ALG_COUNT + i) * rows + row) * r], r));
+                }
+            }
+        }
+        printf("\n");
+    }
+
+    free(times);
+}
@@ -0,0 +1,72 @@
+#ifndef SELECTION_BENCHMARK_BENCH_H
+#define SELECTION_BENCHMARK_BENCH_H
+
+#include "select.h"
+#include "array.h"
+#include "alloc.h"
+
+enum print_type {
+    all = 0,
+    times_only,
+    calls_only,
+    ratios_only,
+    stats_only
+};
+
+#define PIVOT_ALG_COUNT 5
+#define ALG_COUNT 6
+
+extern choose_pivot pivots[PIVOT_ALG_COUNT];
+extern const char *alg_names[ALG_COUNT];
+
+struct bench_config {
+    int n;
+    enum array_type type;
+    int m;
+    int r;
+    int alg_mask;
+    enum print_type print;
+    int fixed_k; /* negative if k should be varied */
+    int iterations;
+    int queries; /* the largest number of queries for the index benchmark */
+    int window; /* the window size for the sliding window benchmark, or 0 to vary it */
+    int quantile; /* the rank within each window, in percent */
+    int workers; /* the number of worker processes for the distributed benchmark */
+    enum alloc_mode alloc; /* how arr was allocated */
+};
+
+int do_select(int *arr, int size, int k, int alg, int record);
+
+/* Runs a random sequence of queries against the same array, and prints the amortized
+ * time per query with and without a select_index as the number of queries grows. */
+void bench_index(const struct bench_config *cfg, int *arr);
+
+/* Times the top-k strategies (selection then sorting the prefix, a heap, and the standard
+ * library's std::partial_sort and std::nth_element + std::sort) for k = 1, 2, 4, ... */
+void bench_topk(const struct bench_config *cfg, int *arr);
+
+/* Times finding the row of the k-th smallest key without moving the keys: through an index array
+ * (in row order or shuffled) and through packed key + row words, against selecting the keys directly. */
+void bench_argselect(const struct bench_config *cfg, int *arr);
+
+/* Measures the throughput (arrays per second) of finding the median of many short segments,
+ * with select_batch() and with one select() call per segment, over several segment length ranges. */
+void bench_batch(const struct bench_config *cfg, int *arr);
+
+/* Measures the throughput (window steps per second) of a quantile over a sliding window,
+ * with a sliding_window and by copying each window and calling select() on it. */
+void bench_window(const struct bench_config *cfg, int *arr);
+
+/* Times select_readonly() with a reused arena against copying the whole array and selecting in the copy,
+ * and reports the scratch memory each of them needs. */
+void bench_readonly(const struct bench_config *cfg, int *arr);
+
+/* Compares selection over an array sharded across worker processes with gathering every shard and
+ * calling select(), in latency, rounds and bytes exchanged. */
+void bench_distributed(const struct bench_config *cfg, int *arr);
+
+/* Times every enabled algorithm over a range of k for each allocation mode of the array, to show how much
+ * of its cost comes from TLB misses or remote NUMA memory. Allocates its own arrays. */
+void bench_alloc(const struct bench_config *cfg);
+
+#endif //SELECTION_BENCHMARK_BENCH_H
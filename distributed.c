@@ -0,0 +1,350 @@
+#define _POSIX_C_SOURCE 200809L /* for fork(), pipe(), sigaction() and clock_gettime() */
+
+#include "distributed.h"
+#include "select.h"
+#include "util.h"
+
+#include <limits.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+enum command {
+    cmd_start = 0, /* reset the candidates to the whole shard, reply with their count */
+    cmd_sample,    /* reply with a random sample of a candidates (with replacement) */
+    cmd_count,     /* reply with the number of candidates < a, == a, in (a..b), == b (if b != a) and > b */
+    cmd_keep,      /* keep only the candidates of one of the ranges of the last count, see enum count_range */
+    cmd_gather,    /* reply with the count and the candidates themselves */
+    cmd_exit
+};
+
+/* the ranges that cmd_count counts; counting the pivots separately guarantees progress with equal values */
+enum count_range {
+    below_lo = 0,
+    equal_lo,
+    inside,
+    equal_hi,
+    above_hi,
+    count_range_end
+};
+
+struct message {
+    int command;
+    int a;
+    int b;
+};
+
+struct shard_cluster {
+    int workers;
+    int n;
+    pid_t *pids;
+    int *to_worker;   /* write ends of the command pipes */
+    int *from_worker; /* read ends of the reply pipes */
+    long long bytes;
+    struct sigaction old_sigpipe; /* restored by cluster_stop() */
+};
+
+static int write_all(int fd, const void *buf, size_t size) {
+    const char *p = buf;
+    while (size > 0) {
+        ssize_t written = write(fd, p, size);
+        if (written <= 0) {
+            return 0;
+        }
+        p += written;
+        size -= (size_t) written;
+    }
+    return 1;
+}
+
+static int read_all(int fd, void *buf, size_t size) {
+    char *p = buf;
+    while (size > 0) {
+        ssize_t got = read(fd, p, size);
+        if (got <= 0) {
+            return 0;
+        }
+        p += got;
+        size -= (size_t) got;
+    }
+    return 1;
+}
+
+static void worker_main(const int *shard, int len, int in, int out, int id) {
+    int *candidates = malloc(sizeof(int) * (len + 1));
+    int *buf = malloc(sizeof(int) * (len + 1));
+    int count = 0, lo = INT_MIN, hi = INT_MAX;
+    struct message msg;
+    if (candidates == NULL || buf == NULL) {
+        _exit(1);
+    }
+    seed((uint32_t) id + 1);
+
+    while (read_all(in, &msg, sizeof(msg))) {
+        int reply[count_range_end];
+        switch (msg.command) {
+        case cmd_start:
+            memcpy(candidates, shard, sizeof(int) * len);
+            count = len;
+            write_all(out, &count, sizeof(int));
+            break;
+        case cmd_sample:
+            for (int i = 0; i < msg.a; i++) {
+                buf[i] = candidates[randint() % count];
+            }
+            write_all(out, buf, sizeof(int) * msg.a);
+            break;
+        case cmd_count:
+            lo = msg.a;
+            hi = msg.b;
+            memset(reply, 0, sizeof(reply));
+            for (int i = 0; i < count; i++) {
+                int x = candidates[i];
+                reply[below_lo] += x < lo;
+                reply[equal_lo] += x == lo;
+                reply[inside] += (x > lo) & (x < hi);
+                reply[equal_hi] += (x == hi) & (hi != lo);
+            }
+            reply[above_hi] = count - reply[below_lo] - reply[equal_lo] - reply[inside] - reply[equal_hi];
+            write_all(out, reply, sizeof(reply));
+            break;
+        case cmd_keep: {
+            int kept = 0;
+            for (int i = 0; i < count; i++) {
+                int x = candidates[i];
+                candidates[kept] = x;
+                kept += msg.a == below_lo ? x < lo : msg.a == inside ? x > lo && x < hi : x > hi;
+            }
+            count = kept;
+            break;
+        }
+        case cmd_gather:
+            write_all(out, &count, sizeof(int));
+            write_all(out, candidates, sizeof(int) * count);
+            break;
+        default:
+            free(candidates);
+            free(buf);
+            _exit(0);
+        }
+    }
+    _exit(0);
+}
+
+struct shard_cluster *cluster_start(const int *arr, int n, int workers) {
+    struct shard_cluster *cluster = malloc(sizeof(struct shard_cluster));
+    if (cluster == NULL) {
+        return NULL;
+    }
+    cluster->workers = 0;
+    cluster->n = n;
+    cluster->bytes = 0;
+    /* a worker that died must show up as a failed write(), not kill the benchmark with SIGPIPE */
+    struct sigaction ignore;
+    memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPIPE, &ignore, &cluster->old_sigpipe);
+    cluster->pids = malloc(sizeof(pid_t) * workers);
+    cluster->to_worker = malloc(sizeof(int) * workers);
+    cluster->from_worker = malloc(sizeof(int) * workers);
+    if (cluster->pids == NULL || cluster->to_worker == NULL || cluster->from_worker == NULL) {
+        cluster_stop(cluster);
+        return NULL;
+    }
+
+    /* the workers must not flush a copy of our buffered output */
+    fflush(stdout);
+    fflush(stderr);
+    for (int w = 0; w < workers; w++) {
+        int commands[2], replies[2];
+        if (pipe(commands) != 0) {
+            cluster_stop(cluster);
+            return NULL;
+        }
+        if (pipe(replies) != 0) {
+            close(commands[0]);
+            close(commands[1]);
+            cluster_stop(cluster);
+            return NULL;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            /* the worker only keeps its own ends of its own pipes */
+            for (int i = 0; i < w; i++) {
+                close(cluster->to_worker[i]);
+                close(cluster->from_worker[i]);
+            }
+            close(commands[1]);
+            close(replies[0]);
+            int from = (int) ((long long) n * w / workers), to = (int) ((long long) n * (w + 1) / workers);
+            worker_main(arr + from, to - from, commands[0], replies[1], w);
+        }
+        close(commands[0]);
+        close(replies[1]);
+        if (pid < 0) {
+            close(commands[1]);
+            close(replies[0]);
+            cluster_stop(cluster);
+            return NULL;
+        }
+        cluster->pids[w] = pid;
+        cluster->to_worker[w] = commands[1];
+        cluster->from_worker[w] = replies[0];
+        cluster->workers++;
+    }
+    return cluster;
+}
+
+void cluster_stop(struct shard_cluster *cluster) {
+    struct message msg = {cmd_exit, 0, 0};
+    if (cluster == NULL) {
+        return;
+    }
+    for (int w = 0; w < cluster->workers; w++) {
+        write_all(cluster->to_worker[w], &msg, sizeof(msg));
+        close(cluster->to_worker[w]);
+        close(cluster->from_worker[w]);
+        waitpid(cluster->pids[w], NULL, 0);
+    }
+    sigaction(SIGPIPE, &cluster->old_sigpipe, NULL);
+    free(cluster->pids);
+    free(cluster->to_worker);
+    free(cluster->from_worker);
+    free(cluster);
+}
+
+static int send_command(struct shard_cluster *cluster, int w, int command, int a, int b) {
+    struct message msg = {command, a, b};
+    cluster->bytes += sizeof(msg);
+    return write_all(cluster->to_worker[w], &msg, sizeof(msg));
+}
+
+static int receive(struct shard_cluster *cluster, int w, int *buf, int count) {
+    cluster->bytes += (long long) sizeof(int) * count;
+    return read_all(cluster->from_worker[w], buf, sizeof(int) * count);
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1000. + (double) ts.tv_nsec / 1E6;
+}
+
+int cluster_select(struct shard_cluster *cluster, int k, int gather_threshold, struct distributed_stats *stats,
+                   int *out) {
+    int workers = cluster->workers;
+    int *counts = malloc(sizeof(int) * workers);
+    int *replies = malloc(sizeof(int) * count_range_end * workers);
+    int *buf = NULL;
+    int total = 0, res = 0, found = 0;
+    int ok = counts != NULL && replies != NULL;
+    double start = now_ms();
+    cluster->bytes = 0;
+    stats->rounds = 0;
+
+    for (int w = 0; ok && w < workers; w++) {
+        ok = send_command(cluster, w, cmd_start, 0, 0);
+    }
+    for (int w = 0; ok && w < workers; w++) {
+        ok = receive(cluster, w, &counts[w], 1);
+        total += ok ? counts[w] : 0;
+    }
+
+    while (ok && !found && total > gather_threshold) {
+        /* each worker contributes to the sample in proportion to its number of candidates */
+        int s = 0, lo = 0, hi = 0;
+        int sample_size = (int) pow((double) total, 2. / 3.);
+        int spread = (int) (2. * sqrt((double) sample_size));
+        buf = malloc(sizeof(int) * (sample_size + workers));
+        ok = buf != NULL;
+        for (int w = 0; ok && w < workers; w++) {
+            int share = counts[w] == 0 ? 0 : (int) ((long long) sample_size * counts[w] / total) + 1;
+            ok = send_command(cluster, w, cmd_sample, share, 0);
+            counts[w] = share; /* reused to remember the size of each reply */
+        }
+        for (int w = 0; ok && w < workers; w++) {
+            ok = receive(cluster, w, &buf[s], counts[w]);
+            s += counts[w];
+        }
+
+        /* the same rank estimate as select_readonly(): a band of about 4 standard deviations around k,
+         * which stops at the smallest or largest sample near the ends */
+        int loc = (int) ((long long) k * s / total);
+        int lo_rank = MAX(loc - spread, 0), hi_rank = MIN(loc + spread, s - 1);
+        if (ok) {
+            lo = select(buf, 0, s, lo_rank, sampling_pivot, 0);
+            hi = select(buf, lo_rank, s, hi_rank, sampling_pivot, 0);
+        }
+        free(buf);
+        buf = NULL;
+
+        long long totals[count_range_end] = {0};
+        for (int w = 0; ok && w < workers; w++) {
+            ok = send_command(cluster, w, cmd_count, lo, hi);
+        }
+        for (int w = 0; ok && w < workers; w++) {
+            ok = receive(cluster, w, &replies[count_range_end * w], count_range_end);
+            for (int i = 0; ok && i < count_range_end; i++) {
+                totals[i] += replies[count_range_end * w + i];
+            }
+        }
+        if (!ok) {
+            break;
+        }
+        stats->rounds++;
+
+        /* find the range that holds k */
+        int range = 0;
+        while (k >= totals[range]) {
+            k -= (int) totals[range];
+            range++;
+        }
+        if (range == equal_lo || range == equal_hi) {
+            res = range == equal_lo ? lo : hi;
+            found = 1;
+            break;
+        }
+        int new_total = 0;
+        for (int w = 0; ok && w < workers; w++) {
+            ok = send_command(cluster, w, cmd_keep, range, 0);
+            counts[w] = replies[count_range_end * w + range];
+            new_total += counts[w];
+        }
+        total = new_total;
+    }
+
+    if (ok && !found) {
+        int gathered = 0;
+        buf = malloc(sizeof(int) * (total + 1));
+        ok = buf != NULL;
+        for (int w = 0; ok && w < workers; w++) {
+            ok = send_command(cluster, w, cmd_gather, 0, 0);
+        }
+        for (int w = 0; ok && w < workers; w++) {
+            int count;
+            ok = receive(cluster, w, &count, 1) && count >= 0 && count <= total - gathered &&
+                 receive(cluster, w, &buf[gathered], count);
+            gathered += count;
+        }
+        if (ok) {
+            res = select(buf, 0, gathered, k, sampling_pivot, 0);
+        }
+    }
+
+    stats->bytes = cluster->bytes;
+    stats->latency_ms = now_ms() - start;
+    free(buf);
+    free(counts);
+    free(replies);
+    if (ok) {
+        *out = res;
+    }
+    return ok;
+}
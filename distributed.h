@@ -0,0 +1,30 @@
+#ifndef SELECTION_BENCHMARK_DISTRIBUTED_H
+#define SELECTION_BENCHMARK_DISTRIBUTED_H
+
+/* Selection over an array that is split into shards held by separate worker processes, which stand in for
+ * the nodes of a distributed system. The processes only talk to the coordinator (the calling process)
+ * through pipes, so the number of rounds and bytes they exchange is what a real cluster would see. */
+
+struct shard_cluster;
+
+struct distributed_stats {
+    int rounds;        /* sampling rounds before the remaining candidates were gathered */
+    long long bytes;   /* bytes sent between the coordinator and the workers */
+    double latency_ms; /* wall-clock time */
+};
+
+/* Forks the workers, each of which keeps its own copy of a contiguous shard of arr[0..n).
+ * SIGPIPE is ignored until cluster_stop(), so that a dead worker only makes cluster_select() fail.
+ * Returns NULL if the workers could not be started. */
+struct shard_cluster *cluster_start(const int *arr, int n, int workers);
+void cluster_stop(struct shard_cluster *cluster);
+
+/* Stores the k-th smallest element of the array the cluster was started with in out. In each round, the workers
+ * send a sample of their candidates, the coordinator picks two pivots around the estimated rank of k in the
+ * sample, and the workers count and keep the candidates on the side of (or between) the pivots that holds k.
+ * Once at most gather_threshold candidates are left, they are gathered and select() is called on them, so
+ * a gather_threshold of n gathers everything at once. Returns 0 if a worker stopped answering or memory ran out. */
+int cluster_select(struct shard_cluster *cluster, int k, int gather_threshold, struct distributed_stats *stats,
+                   int *out);
+
+#endif //SELECTION_BENCHMARK_DISTRIBUTED_H
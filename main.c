@@ -8,25 +8,9 @@
 #include "array.h"
 #include "util.h"
 #include "stats.h"
-#include "select_cpp.h"
-
-enum print_type {
-    all = 0,
-    times_only,
-    calls_only,
-    ratios_only
-};
-
-enum array_type {
-    ascending = 0,
-    shuffled,
-    uniform,
-    rotated,
-    nearly_sorted,
-    pyramid,
-    many_duplicates,
-    array_type_end
-};
+#include "bench.h"
+#include "results.h"
+#include "alloc.h"
 
 static const char* array_type_chars = "asurnpm";
 
@@ -40,35 +24,30 @@ static const char* array_type_names[] = {
     "many duplicates"
 };
 
-#define PIVOT_ALG_COUNT 5
-#define ALG_COUNT 6
-
-static choose_pivot pivots[] = {
-//    first_pivot,
-    random_pivot,
-//    med3_pivot,
-    ninther_pivot,
-    deterministic_pivot,
-//    deterministic_adaptive_pivot,
-//    deterministic_strided_pivot,
-    deterministic_adaptive_strided_pivot,
-    sampling_pivot
+enum bench_mode {
+    sweep = 0,
+    index_queries,
+    top_k,
+    arg_select,
+    batched,
+    window,
+    read_only,
+    distributed,
+    alloc_modes,
+    bench_mode_end
 };
 
-static const char* alg_names[] = {
-//    "First",
-    "Random",
-//    "Median of 3",
-    "Ninther",
-    "BFPRT",
-//    "BFPRTA",
-//    "BFPRT+",
-    "BFPRTA+",
-    "Sampling",
-    "libstdc++",
-};
+static const char* bench_mode_chars = "sitabwrdm";
 
 #define DEFAULT_ITERATIONS 51
+#define DEFAULT_QUERIES 1024
+#define DEFAULT_BUDGET_MS 10000
+#define MIN_ADAPTIVE_REPS 5
+#define MAX_ADAPTIVE_REPS 1000
+#define BOOTSTRAP_RESAMPLES 1000
+#define CONFIDENCE 0.95
+#define DEFAULT_MIN_SLOWDOWN 0.05
+#define DEFAULT_WORKERS 4
 
 static int parse_int_arg(const char *err_msg, int min) {
     int n = (int) strtol(optarg, NULL, 0);
@@ -79,16 +58,8 @@ static int parse_int_arg(const char *err_msg, int min) {
     return n;
 }
 
-static int do_select(int *arr, int size, int k, int alg, int record) {
-    if (alg < PIVOT_ALG_COUNT) {
-        return select(arr, 0, size, k, pivots[alg], record);
-    } else {
-        return select_cpp(arr, 0, size, k);
-    }
-}
-
 static void print_stats(int alg_mask, int fixed_k, int iterations, int print, int n, float **arr, const char *name) {
-    if (print == all) {
+    if (print == all || print == stats_only) {
         printf("\n%s\n", name);
     }
     printf("k/L");
@@ -118,10 +89,23 @@ int main(int argc, char **argv) {
     enum print_type print = all;
     int iterations = DEFAULT_ITERATIONS;
     int alg_mask = 0xFFFF;
+    int queries = DEFAULT_QUERIES;
+    int window_size = 0;
+    int quantile = 50;
+    double ci_width = 0.; /* adaptive repetition is disabled if zero */
+    int budget_ms = DEFAULT_BUDGET_MS;
+    const char *json_path = NULL;
+    const char *baseline_path = NULL;
+    double min_slowdown = DEFAULT_MIN_SLOWDOWN;
+    int slowdowns = 0;
+    int workers = DEFAULT_WORKERS;
+    enum alloc_mode alloc = alloc_malloc;
+    int cpu = -1;
+    enum bench_mode mode = sweep;
     int opt;
 
     /* parse arguments */
-    while ((opt = getopt(argc, argv, "n:t:m:r:p:k:i:a:")) != -1) {
+    while ((opt = getopt(argc, argv, "n:t:m:r:p:k:i:a:x:q:w:l:c:b:o:g:d:P:M:T:")) != -1) {
         switch (opt) {
         case 'n':
             n = parse_int_arg("-n (array size) must be a positive integer", 1);
@@ -163,8 +147,11 @@ int main(int argc, char **argv) {
             case 'r':
                 print = ratios_only;
                 break;
+            case 's':
+                print = stats_only;
+                break;
             default:
-                fprintf(stderr, "-p option (print type) must be one of 'a', 't', 'c', or 'r'\n");
+                fprintf(stderr, "-p option (print type) must be one of 'a', 't', 'c', 'r', or 's'\n");
                 exit(1);
             }
             break;
@@ -181,6 +168,75 @@ int main(int argc, char **argv) {
                 exit(1);
             }
             break;
+        case 'x':
+            mode = bench_mode_end;
+            for (int i = 0; i < bench_mode_end; i++) {
+                if (optarg[0] == bench_mode_chars[i]) {
+                    mode = i;
+                    break;
+                }
+            }
+            if (mode == bench_mode_end) {
+                fprintf(stderr, "Invalid benchmark mode: valid modes are 'sweep', 'index', 'topk', 'argselect', 'batch', 'window', 'readonly', 'distributed', and 'memory'\n");
+                exit(1);
+            }
+            break;
+        case 'q':
+            queries = parse_int_arg("-q (number of queries) must be a positive integer", 1);
+            break;
+        case 'c':
+            ci_width = strtod(optarg, NULL);
+            if (ci_width <= 0.) {
+                fprintf(stderr, "-c (relative confidence interval width) must be positive\n");
+                exit(1);
+            }
+            break;
+        case 'b':
+            budget_ms = parse_int_arg("-b (time budget) must be a positive integer", 1);
+            break;
+        case 'P':
+            workers = parse_int_arg("-P (number of workers) must be a positive integer", 1);
+            break;
+        case 'M':
+            alloc = alloc_mode_end;
+            for (int i = 0; i < alloc_mode_end; i++) {
+                if (strcmp(optarg, alloc_mode_names[i]) == 0) {
+                    alloc = i;
+                    break;
+                }
+            }
+            if (alloc == alloc_mode_end) {
+                fprintf(stderr, "Invalid allocation mode: valid modes are "
+                                "'malloc', 'thp', 'hugetlb', 'local', and 'interleave'\n");
+                exit(1);
+            }
+            break;
+        case 'T':
+            cpu = parse_int_arg("-T (cpu) must be a non-negative integer", 0);
+            break;
+        case 'o':
+            json_path = optarg;
+            break;
+        case 'g':
+            baseline_path = optarg;
+            break;
+        case 'd':
+            min_slowdown = strtod(optarg, NULL);
+            if (min_slowdown < 0.) {
+                fprintf(stderr, "-d (minimum slowdown) must be non-negative\n");
+                exit(1);
+            }
+            break;
+        case 'w':
+            window_size = parse_int_arg("-w (window size) must be a positive integer", 1);
+            break;
+        case 'l':
+            quantile = parse_int_arg("-l (quantile) must be in [0..100]", 0);
+            if (quantile > 100) {
+                fprintf(stderr, "-l (quantile) must be in [0..100]\n");
+                exit(1);
+            }
+            break;
         default:
             fprintf(stderr, "Usage: %s [-n size] [-t type] [options]... \n", argv[0]);
             fprintf(stderr, "    -n: Size of array (default: 1000000)\n"
@@ -190,11 +246,41 @@ int main(int argc, char **argv) {
                             "        ascending/shuffled: the stride of the ascending (or shuffled) array (default: 1)\n"
                             "        random: the range of the random numbers in the array (default: n)\n"
                             "    -r: Number of times to repeat each run (default: 10)\n"
-                            "    -p: What data to print. (a: all, t: times only, c: calls only, r: ratios only)\n"
+                            "    -p: What data to print. (a: all, t: times only, c: calls only, r: ratios only,\n"
+                            "        s: median, p95 and confidence interval of the times only)\n"
                             "    -k: The order of the element to find.\n"
                             "        If not specified, a range of values are uniformly selected from 0 to n - 1.\n"
                             "    -i: The number of iterations (number of columns output, default: %d)\n"
-                            "    -a: A binary mask of algorithms to run. (ex. 100101)\n", DEFAULT_ITERATIONS);
+                            "    -a: A binary mask of algorithms to run. (ex. 100101)\n"
+                            "    -x: Benchmark mode (sweep/index/topk/argselect/batch/window/readonly/distributed/memory,\n"
+                            "        default: sweep)\n"
+                            "        sweep: time a single selection over a range of k\n"
+                            "        index: time a sequence of random queries on the same array, with and without an index\n"
+                            "        topk: time finding the k smallest elements in sorted order for k = 1, 2, 4, ...\n"
+                            "        argselect: time finding the row of the k-th key without moving the keys\n"
+                            "        batch: measure medians per second over many short segments of the array\n"
+                            "        window: measure a quantile over a sliding window of the array\n"
+                            "        readonly: time selection that leaves the array unmodified, against copying it first\n"
+                            "        distributed: select over shards held by worker processes, against gathering them\n"
+                            "        memory: time every algorithm with each allocation mode (-M) of the array\n"
+                            "    -q: The largest number of queries in index mode (default: %d)\n"
+                            "    -w: The window size in window mode (default: 16, 64, 256, ...)\n"
+                            "    -l: The quantile to find in each window in window mode, in percent (default: 50)\n"
+                            "    -c: Instead of -r reps, repeat each run at least %d and at most %d times, until the %g%%\n"
+                            "        confidence interval of the median time is narrower than this fraction of the median\n"
+                            "        (ex. 0.02, default: off)\n"
+                            "    -b: The time budget for each run with -c, in ms (default: %d)\n"
+                            "    -P: The number of worker processes in distributed mode (default: %d)\n"
+                            "    -M: How to allocate the array (malloc/thp/hugetlb/local/interleave, default: malloc)\n"
+                            "        thp: transparent huge pages, hugetlb: explicit huge pages (must be reserved),\n"
+                            "        local: bound to the local NUMA node, interleave: interleaved over all NUMA nodes\n"
+                            "    -T: Pin the benchmark to this CPU\n"
+                            "    -o: Also write the results of the sweep to this file as JSON\n"
+                            "    -g: Compare the results of the sweep with a baseline written by -o, and exit with code 2\n"
+                            "        if any algorithm is significantly slower at any k\n"
+                            "    -d: The smallest relative slowdown that -g reports (default: %g)\n",
+                            DEFAULT_ITERATIONS, DEFAULT_QUERIES, MIN_ADAPTIVE_REPS, MAX_ADAPTIVE_REPS, CONFIDENCE * 100., DEFAULT_BUDGET_MS, DEFAULT_WORKERS,
+                            DEFAULT_MIN_SLOWDOWN);
             exit(1);
         }
     }
@@ -237,36 +323,108 @@ int main(int argc, char **argv) {
         exit(1);
     }
 
+    if (window_size > n) {
+        fprintf(stderr, "-w (window size) must be <= n\n");
+        exit(1);
+    }
+
+    if (mode != sweep && (json_path != NULL || baseline_path != NULL)) {
+        fprintf(stderr, "-o and -g are only supported in sweep mode\n");
+        exit(1);
+    }
+
     if (fixed_k >= n) {
         fprintf(stderr, "-k (element order) must be < n\n");
         exit(1);
     }
 
-    /* initialize array */
-    arr = malloc(sizeof(int) * n);
-    if (arr == NULL) {
-        fprintf(stderr, "Array allocation failed.\n");
+    /* pin before allocating, so that first-touch pages land on the node of the pinned cpu */
+    if (cpu >= 0 && !pin_to_cpu(cpu)) {
+        fprintf(stderr, "Could not pin the benchmark to cpu %d.\n", cpu);
         exit(1);
     }
 
+    /* initialize array (the allocation mode benchmark allocates its own) */
+    if (mode != alloc_modes) {
+        arr = alloc_array(n, alloc);
+        if (arr == NULL) {
+            fprintf(stderr, "Array allocation failed (allocation mode: %s).\n", alloc_mode_names[alloc]);
+            exit(1);
+        }
+    }
+
     fprintf(stderr, "Note: progress information will be written to stderr.\n"
                     "It is recommended to redirect stdout to a separate file, "
                     "otherwise the text will be intermixed and confusing.\n");
 
     /* print array info (csv) */
     if (print == all) {
-        printf("array size,type,m\n");
-        printf("%d,%s,%d\n", n, array_type_names[type], m);
+        printf("array size,type,m,allocation,cpu\n");
+        printf("%d,%s,%d,%s,%d\n", n, array_type_names[type], m,
+               mode == alloc_modes ? "all" : alloc_mode_names[alloc], cpu);
+    }
+
+    if (mode != sweep) {
+        struct bench_config cfg = {
+            .n = n, .type = type, .m = m, .r = r, .alg_mask = alg_mask, .print = print,
+            .fixed_k = fixed_k, .iterations = iterations, .queries = queries,
+            .window = window_size, .quantile = quantile, .workers = workers,
+            .alloc = alloc
+        };
+        switch (mode) {
+        case index_queries:
+            bench_index(&cfg, arr);
+            break;
+        case top_k:
+            bench_topk(&cfg, arr);
+            break;
+        case arg_select:
+            bench_argselect(&cfg, arr);
+            break;
+        case batched:
+            bench_batch(&cfg, arr);
+            break;
+        case window:
+            bench_window(&cfg, arr);
+            break;
+        case read_only:
+            bench_readonly(&cfg, arr);
+            break;
+        case distributed:
+            bench_distributed(&cfg, arr);
+            break;
+        case alloc_modes:
+            bench_alloc(&cfg);
+            break;
+        default:
+            break;
+        }
+        free_array(arr, n, alloc);
+        return 0;
     }
 
     float *times[ALG_COUNT];
     float *calls[ALG_COUNT];
     float *ratios[ALG_COUNT];
+    float *medians[ALG_COUNT];
+    float *p95s[ALG_COUNT];
+    float *ci_lows[ALG_COUNT];
+    float *ci_highs[ALG_COUNT];
+    float *reps[ALG_COUNT];
+    /* with -c, -r is replaced by a small minimum so that stable runs can finish early */
+    int min_reps = ci_width > 0. ? MIN_ADAPTIVE_REPS : r;
+    int max_reps = ci_width > 0. ? MAX_ADAPTIVE_REPS : r;
+    float *rep_times = malloc(sizeof(float) * max_reps);
 
     for (int i = 0; i < ALG_COUNT; i++) {
         times[i] = malloc(sizeof(float) * iterations);
         calls[i] = malloc(sizeof(float) * iterations);
         ratios[i] = malloc(sizeof(float) * iterations);
+        medians[i] = malloc(sizeof(float) * iterations);
+        p95s[i] = malloc(sizeof(float) * iterations);
+        ci_lows[i] = malloc(sizeof(float) * iterations);
+        ci_highs[i] = malloc(sizeof(float) * iterations);
+        reps[i] = malloc(sizeof(float) * iterations);
     }
 
     /* do the benchmarks */
@@ -276,63 +434,37 @@ int main(int argc, char **argv) {
         }
         for (int j = 0; j < iterations; j++) {
             int res;
-            int target = fixed_k < 0 ? ((n - 1) * j) / (iterations - 1) : fixed_k;
+            int target = fixed_k < 0 ? (int) ((long long) (n - 1) * j / (iterations - 1)) : fixed_k;
             clock_t start, end;
+            clock_t budget_start = clock();
             float time_sum = 0.f;
             float time_max = 0.f;
             float time_min = 1.f / 0.f; /* infinity */
             float calls_sum = 0.f;
             float bad_pivot_sum = 0.f;
+            double ci_low = 0., ci_high = 0.;
+            int count = 0;
 
-            for (int k = 0; k < r; k++) {
+            for (int k = 0; k < max_reps; k++) {
                 float curr_time;
 
                 int checksum;
-                fprintf(stderr, "\r%s: %3d/%3d (%2d/%2d)", alg_names[i], j, iterations - 1, k + 1, r);
+                fprintf(stderr, "\r%s: %3d/%3d (%2d/%2d)", alg_names[i], j, iterations - 1, k + 1, max_reps);
 
                 seed(fixed_k < 0 ? k + 1 : j + 1);
 
-                switch (type) {
-                case ascending:
-                    fill_sequence(arr, 0, n, 0, m, n);
-                    break;
-                case shuffled:
-                    fill_sequence(arr, 0, n, 0, m, n);
-                    shuffle(arr, 0, n);
-                    break;
-                case uniform:
-                    fill_random(arr, 0, n, 0, m);
-                    break;
-                case rotated:
-                    fill_sequence(arr, 0, n - m, m, 1, n);
-                    fill_sequence(arr, n - m, n, 0, 1, n);
-                    break;
-                case nearly_sorted:
-                    fill_sequence(arr, 0, n, 0, 1, n);
-                    swap_random(arr, 0, n, m);
-                    break;
-                case pyramid:
-                    fill_pyramid(arr, 0, n, m);
-                    shuffle(arr, 0, n);
-                    break;
-                case many_duplicates:
-                    fill_sequence(arr, 0, n, 0, 1, n);
-                    fill_sequence(arr, 0, m, 0, 0, 1);
-                    shuffle(arr, 0, n);
-                    break;
-                default:
-                    break;
-                }
+                fill_array(arr, n, type, m);
 
                 checksum = xor_sum(arr, 0, n);
 
                 reset_num_calls();
 
                 start = clock();
-                res = do_select(arr, n, target, i, print != times_only);
+                res = do_select(arr, n, target, i, print != times_only && print != stats_only);
                 end = clock();
 
                 curr_time = (float) (end - start) * 1000.f / CLOCKS_PER_SEC;
+                rep_times[count++] = curr_time;
                 time_sum += curr_time;
                 calls_sum += (float) get_num_calls();
                 bad_pivot_sum += (float) get_bad_pivot_count();
@@ -347,12 +479,32 @@ int main(int argc, char **argv) {
                 if (!check_select(arr, 0, n, target, res) || checksum != xor_sum(arr, 0, n)) {
                     fprintf(stderr, "Algorithm %s is incorrect!\n", alg_names[i]);
                 }
+
+                /* adaptive repetition: once the first min_reps reps are done, stop as soon as the confidence interval
+                 * of the median is narrow enough. It is rechecked after every ~10% more reps, since each check
+                 * costs BOOTSTRAP_RESAMPLES sorts. */
+                if (ci_width > 0. && count >= min_reps && (count - min_reps) % MAX(1, count / 10) == 0) {
+                    bootstrap_median_ci(rep_times, count, BOOTSTRAP_RESAMPLES, CONFIDENCE, &ci_low, &ci_high);
+                    if (ci_high - ci_low <= ci_width * median(rep_times, count) ||
+                        (float) (clock() - budget_start) * 1000.f / CLOCKS_PER_SEC > (float) budget_ms) {
+                        break;
+                    }
+                }
+            }
+
+            if (ci_width <= 0.) {
+                bootstrap_median_ci(rep_times, count, BOOTSTRAP_RESAMPLES, CONFIDENCE, &ci_low, &ci_high);
             }
 
             /* eliminate outliers */
-            times[i][j] = r < 3 ? (time_sum / (float) r) : (time_sum - time_min - time_max) / (float) (r - 2);
-            calls[i][j] = calls_sum / (float) r;
+            times[i][j] = count < 3 ? (time_sum / (float) count) : (time_sum - time_min - time_max) / (float) (count - 2);
+            calls[i][j] = calls_sum / (float) count;
             ratios[i][j] = bad_pivot_sum / (calls_sum + 1E-9f); // prevent division by zero
+            medians[i][j] = (float) median(rep_times, count);
+            p95s[i][j] = (float) percentile(rep_times, count, 0.95);
+            ci_lows[i][j] = (float) ci_low;
+            ci_highs[i][j] = (float) ci_high;
+            reps[i][j] = (float) count;
         }
         fprintf(stderr, " OK\n");
     }
@@ -371,6 +523,14 @@ int main(int argc, char **argv) {
         print_stats(alg_mask, fixed_k, iterations, print, n, ratios, "ratio of bad pivot choices");
     }
 
+    if (print == all || print == stats_only) {
+        print_stats(alg_mask, fixed_k, iterations, print, n, medians, "median time (ms)");
+        print_stats(alg_mask, fixed_k, iterations, print, n, p95s, "p95 time (ms)");
+        print_stats(alg_mask, fixed_k, iterations, print, n, ci_lows, "median time confidence interval low (ms)");
+        print_stats(alg_mask, fixed_k, iterations, print, n, ci_highs, "median time confidence interval high (ms)");
+        print_stats(alg_mask, fixed_k, iterations, print, n, reps, "repetitions");
+    }
+
     if (print == all) {
         printf("\npivot alg,time (ms),min,max,stddev,fn calls,min,max,stddev,bad pivot ratio,min,max,stddev\n");
         for (int i = 0; i < ALG_COUNT; i++) {
@@ -393,11 +553,74 @@ int main(int argc, char **argv) {
                    stddev(ratios[i], iterations));
         }
     }
-    free(arr);
+    if (json_path != NULL || baseline_path != NULL) {
+        struct result_config config = {.n = n, .m = m, .iterations = iterations, .fixed_k = fixed_k,
+                                       .min_reps = min_reps, .max_reps = max_reps, .ci_width = ci_width,
+                                       .budget_ms = budget_ms, .cpu = cpu};
+        struct result_point *points = malloc(sizeof(struct result_point) * ALG_COUNT * iterations);
+        int count = 0;
+        if (points == NULL) {
+            fprintf(stderr, "Array allocation failed.\n");
+            exit(1);
+        }
+        snprintf(config.type, sizeof(config.type), "%s", array_type_names[type]);
+        snprintf(config.alloc, sizeof(config.alloc), "%s", alloc_mode_names[alloc]);
+        describe_environment(&config);
+        for (int i = 0; i < ALG_COUNT; i++) {
+            if ((alg_mask & (1 << i)) == 0) {
+                continue;
+            }
+            for (int j = 0; j < iterations; j++) {
+                struct result_point *p = &points[count++];
+                snprintf(p->algorithm, sizeof(p->algorithm), "%s", alg_names[i]);
+                p->k = fixed_k < 0 ? (int) ((long long) (n - 1) * j / (iterations - 1)) : fixed_k;
+                p->mean = times[i][j];
+                p->median = medians[i][j];
+                p->p95 = p95s[i][j];
+                p->ci_low = ci_lows[i][j];
+                p->ci_high = ci_highs[i][j];
+                p->reps = (int) reps[i][j];
+            }
+        }
+
+        if (json_path != NULL && !write_results_json(json_path, &config, points, count)) {
+            fprintf(stderr, "Could not write results to %s\n", json_path);
+            exit(1);
+        }
+
+        if (baseline_path != NULL) {
+            struct result_config baseline_config;
+            struct result_point *baseline;
+            int baseline_count;
+            if (!read_results_json(baseline_path, &baseline_config, &baseline, &baseline_count)) {
+                fprintf(stderr, "Could not read baseline from %s\n", baseline_path);
+                exit(1);
+            }
+            slowdowns = compare_results(&baseline_config, baseline, baseline_count,
+                                        &config, points, count, min_slowdown);
+            if (slowdowns < 0) {
+                fprintf(stderr, "Could not compare with the baseline %s\n", baseline_path);
+                exit(1);
+            }
+            if (slowdowns > 0) {
+                fprintf(stderr, "%d significant slowdown(s) compared to %s\n", slowdowns, baseline_path);
+            }
+            free(baseline);
+        }
+        free(points);
+    }
+
+    free_array(arr, n, alloc);
     for (int i = 0; i < ALG_COUNT; i++) {
         free(times[i]);
         free(calls[i]);
         free(ratios[i]);
+        free(medians[i]);
+        free(p95s[i]);
+        free(ci_lows[i]);
+        free(ci_highs[i]);
+        free(reps[i]);
     }
-    return 0;
+    free(rep_times);
+    return slowdowns > 0 ? 2 : 0;
 }
@@ -0,0 +1,250 @@
+#include "results.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BENCH_COMPILE_FLAGS
+#define BENCH_COMPILE_FLAGS "unknown"
+#endif
+
+#if defined(__clang__)
+#define BENCH_COMPILER __VERSION__ /* already names clang */
+#elif defined(__GNUC__)
+#define BENCH_COMPILER "gcc " __VERSION__
+#else
+#define BENCH_COMPILER "unknown"
+#endif
+
+#define LINE_LENGTH 1024
+
+/* reads the value of the first line in path that starts with key (and a ':' for /proc/cpuinfo) */
+static void read_system_value(const char *path, const char *key, char *out, int size) {
+    char line[LINE_LENGTH];
+    FILE *f = fopen(path, "r");
+    snprintf(out, size, "unknown");
+    if (f == NULL) {
+        return;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strncmp(line, key, strlen(key)) != 0) {
+            continue;
+        }
+        char *value = strchr(line, ':');
+        value = value == NULL ? line : value + 1;
+        while (*value == ' ' || *value == '\t') {
+            value++;
+        }
+        value[strcspn(value, "\n")] = '\0';
+        snprintf(out, size, "%s", value);
+        break;
+    }
+    fclose(f);
+}
+
+static void write_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            fputc('\\', f);
+        }
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+void describe_environment(struct result_config *config) {
+    snprintf(config->compiler, sizeof(config->compiler), "%s", BENCH_COMPILER);
+    snprintf(config->flags, sizeof(config->flags), "%s", BENCH_COMPILE_FLAGS);
+    read_system_value("/proc/cpuinfo", "model name", config->cpu_model, sizeof(config->cpu_model));
+    read_system_value("/proc/sys/kernel/osrelease", "", config->kernel, sizeof(config->kernel));
+}
+
+int write_results_json(const char *path, const struct result_config *config,
+                       const struct result_point *points, int count) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return 0;
+    }
+
+    /* every object is kept on a single line so that read_results_json() can stay simple */
+    fprintf(f, "{\n  \"config\": {\"n\": %d, \"type\": ", config->n);
+    write_string(f, config->type);
+    fprintf(f, ", \"m\": %d, \"iterations\": %d, \"fixed_k\": %d, \"min_reps\": %d, \"max_reps\": %d, "
+               "\"ci_width\": %g, \"budget_ms\": %d, \"alloc\": ",
+            config->m, config->iterations, config->fixed_k, config->min_reps, config->max_reps, config->ci_width,
+            config->budget_ms);
+    write_string(f, config->alloc);
+    fprintf(f, ", \"pinned_cpu\": %d, \"compiler\": ", config->cpu);
+    write_string(f, config->compiler);
+    fprintf(f, ", \"flags\": ");
+    write_string(f, config->flags);
+    fprintf(f, ", \"cpu\": ");
+    write_string(f, config->cpu_model);
+    fprintf(f, ", \"kernel\": ");
+    write_string(f, config->kernel);
+    fprintf(f, "},\n  \"results\": [\n");
+    for (int i = 0; i < count; i++) {
+        const struct result_point *p = &points[i];
+        fprintf(f, "    {\"algorithm\": ");
+        write_string(f, p->algorithm);
+        fprintf(f, ", \"k\": %d, \"k/n\": %g, \"mean\": %.5f, \"median\": %.5f, \"p95\": %.5f, "
+                   "\"ci_low\": %.5f, \"ci_high\": %.5f, \"reps\": %d}%s\n",
+                p->k, (double) p->k / config->n, p->mean, p->median, p->p95, p->ci_low, p->ci_high, p->reps,
+                i == count - 1 ? "" : ",");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0;
+}
+
+/* finds "key": in line and returns a pointer to its value, or NULL */
+static const char *find_key(const char *line, const char *key) {
+    char pattern[RESULT_NAME_LENGTH + 4];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *value = strstr(line, pattern);
+    if (value == NULL) {
+        return NULL;
+    }
+    value += strlen(pattern);
+    while (*value == ' ') {
+        value++;
+    }
+    return value;
+}
+
+static double read_number(const char *line, const char *key) {
+    const char *value = find_key(line, key);
+    return value == NULL ? 0. : strtod(value, NULL);
+}
+
+static void read_string(const char *line, const char *key, char *out, int size) {
+    const char *value = find_key(line, key);
+    int len = 0;
+    if (value != NULL && *value == '"') {
+        for (value++; *value != '\0' && *value != '"' && len < size - 1; value++) {
+            if (*value == '\\' && value[1] != '\0') {
+                value++;
+            }
+            out[len++] = *value;
+        }
+    }
+    out[len] = '\0';
+}
+
+int read_results_json(const char *path, struct result_config *config, struct result_point **points, int *count) {
+    char line[LINE_LENGTH * 4];
+    int capacity = 64;
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return 0;
+    }
+    *count = 0;
+    *points = malloc(sizeof(struct result_point) * capacity);
+    if (*points == NULL) {
+        fclose(f);
+        return 0;
+    }
+    memset(config, 0, sizeof(*config));
+
+    int has_config = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (find_key(line, "config") != NULL) {
+            has_config = 1;
+            config->n = (int) read_number(line, "n");
+            read_string(line, "type", config->type, RESULT_NAME_LENGTH);
+            config->m = (int) read_number(line, "m");
+            config->iterations = (int) read_number(line, "iterations");
+            config->fixed_k = find_key(line, "fixed_k") == NULL ? -1 : (int) read_number(line, "fixed_k");
+            config->min_reps = (int) read_number(line, "min_reps");
+            config->max_reps = (int) read_number(line, "max_reps");
+            config->ci_width = read_number(line, "ci_width");
+            config->budget_ms = (int) read_number(line, "budget_ms");
+            read_string(line, "alloc", config->alloc, RESULT_NAME_LENGTH);
+            config->cpu = find_key(line, "pinned_cpu") == NULL ? -1 : (int) read_number(line, "pinned_cpu");
+            read_string(line, "compiler", config->compiler, RESULT_TEXT_LENGTH);
+            read_string(line, "flags", config->flags, RESULT_TEXT_LENGTH);
+            read_string(line, "cpu", config->cpu_model, RESULT_TEXT_LENGTH);
+            read_string(line, "kernel", config->kernel, RESULT_TEXT_LENGTH);
+        } else if (find_key(line, "algorithm") != NULL) {
+            if (*count == capacity) {
+                struct result_point *grown = realloc(*points, sizeof(struct result_point) * capacity * 2);
+                if (grown == NULL) {
+                    free(*points);
+                    fclose(f);
+                    return 0;
+                }
+                *points = grown;
+                capacity *= 2;
+            }
+            struct result_point *p = &(*points)[(*count)++];
+            read_string(line, "algorithm", p->algorithm, RESULT_NAME_LENGTH);
+            p->k = (int) read_number(line, "k");
+            p->mean = (float) read_number(line, "mean");
+            p->median = (float) read_number(line, "median");
+            p->p95 = (float) read_number(line, "p95");
+            p->ci_low = (float) read_number(line, "ci_low");
+            p->ci_high = (float) read_number(line, "ci_high");
+            p->reps = (int) read_number(line, "reps");
+        }
+    }
+    fclose(f);
+    if (!has_config || *count == 0) {
+        free(*points);
+        return 0;
+    }
+    return 1;
+}
+
+int compare_results(const struct result_config *baseline_config, const struct result_point *baseline, int baseline_count,
+                    const struct result_config *config, const struct result_point *points, int count, double min_slowdown) {
+    int slowdowns = 0;
+    int matched = 0;
+    /* k means something else on a different array, so such points must not be compared */
+    if (baseline_config->n != config->n || strcmp(baseline_config->type, config->type) != 0 ||
+        baseline_config->m != config->m || strcmp(baseline_config->alloc, config->alloc) != 0) {
+        fprintf(stderr, "The baseline was run with n = %d, type = %s, m = %d, allocation = %s\n",
+                baseline_config->n, baseline_config->type, baseline_config->m, baseline_config->alloc);
+        return -1;
+    }
+    /* the budget only applies to adaptive repetition */
+    if (baseline_config->iterations != config->iterations || baseline_config->fixed_k != config->fixed_k ||
+        baseline_config->min_reps != config->min_reps || baseline_config->max_reps != config->max_reps ||
+        baseline_config->ci_width != config->ci_width ||
+        (config->ci_width > 0. && baseline_config->budget_ms != config->budget_ms)) {
+        fprintf(stderr, "Warning: the baseline was measured with %d iterations, k = %d, %d-%d reps, "
+                        "ci width = %g, budget = %d ms\n",
+                baseline_config->iterations, baseline_config->fixed_k, baseline_config->min_reps,
+                baseline_config->max_reps, baseline_config->ci_width, baseline_config->budget_ms);
+    }
+    /* a different build or machine can be compared on purpose, but should not be by accident */
+    if (strcmp(baseline_config->compiler, config->compiler) != 0 || strcmp(baseline_config->flags, config->flags) != 0 ||
+        strcmp(baseline_config->cpu_model, config->cpu_model) != 0 ||
+        strcmp(baseline_config->kernel, config->kernel) != 0) {
+        fprintf(stderr, "Warning: the baseline was built with %s (%s) and run on %s, kernel %s\n",
+                baseline_config->compiler, baseline_config->flags, baseline_config->cpu_model, baseline_config->kernel);
+    }
+
+    printf("\ncomparison with baseline\n");
+    printf("pivot alg,k/L,baseline median (ms),median (ms),change,significant slowdown\n");
+    for (int i = 0; i < count; i++) {
+        const struct result_point *p = &points[i];
+        for (int j = 0; j < baseline_count; j++) {
+            const struct result_point *b = &baseline[j];
+            if (b->k != p->k || strcmp(b->algorithm, p->algorithm) != 0) {
+                continue;
+            }
+            double change = b->median > 0.f ? p->median / b->median - 1. : 0.;
+            int significant = p->ci_low > b->ci_high && change > min_slowdown;
+            slowdowns += significant;
+            matched++;
+            printf("%s,%g,%.5f,%.5f,%+.2f%%,%s\n", p->algorithm, (double) p->k / config->n,
+                   b->median, p->median, change * 100., significant ? "yes" : "no");
+            break;
+        }
+    }
+    if (matched == 0) {
+        fprintf(stderr, "None of the results appear in the baseline\n");
+        return -1;
+    }
+    return slowdowns;
+}
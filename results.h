@@ -0,0 +1,56 @@
+#ifndef SELECTION_BENCHMARK_RESULTS_H
+#define SELECTION_BENCHMARK_RESULTS_H
+
+#define RESULT_NAME_LENGTH 32
+#define RESULT_TEXT_LENGTH 256
+
+/* The configuration of a run, written along with its results so that runs can be compared. */
+struct result_config {
+    int n;
+    char type[RESULT_NAME_LENGTH];
+    int m;
+    int iterations;
+    int fixed_k;    /* or -1 if k was varied */
+    int min_reps;
+    int max_reps;
+    double ci_width; /* the -c target, or 0 if the number of reps was fixed */
+    int budget_ms;
+    char alloc[RESULT_NAME_LENGTH];
+    int cpu; /* the cpu the benchmark was pinned to, or -1 */
+    char compiler[RESULT_TEXT_LENGTH];
+    char flags[RESULT_TEXT_LENGTH];
+    char cpu_model[RESULT_TEXT_LENGTH];
+    char kernel[RESULT_TEXT_LENGTH];
+};
+
+/* The timing statistics of one algorithm at one k. */
+struct result_point {
+    char algorithm[RESULT_NAME_LENGTH];
+    int k;
+    float mean;
+    float median;
+    float p95;
+    float ci_low;
+    float ci_high;
+    int reps;
+};
+
+/* Fills in the compiler, compile flags, CPU model and kernel of this build and machine. */
+void describe_environment(struct result_config *config);
+
+/* Writes the results as JSON, along with the configuration. Returns 0 if the file could not be written. */
+int write_results_json(const char *path, const struct result_config *config,
+                       const struct result_point *points, int count);
+
+/* Reads a file written by write_results_json(). The points are allocated with malloc and must be freed by
+ * the caller. Returns 0 if the file could not be read, or holds no configuration or no results. */
+int read_results_json(const char *path, struct result_config *config, struct result_point **points, int *count);
+
+/* Prints a csv table comparing the median times of the points that appear in both runs, and returns the
+ * number of significant slowdowns: points whose confidence intervals do not overlap with the baseline's,
+ * and whose median is more than min_slowdown (a fraction) slower. Returns -1 if the baseline was run on a
+ * different array, or shares no points with this run. Warns if the baseline was measured, built or run differently. */
+int compare_results(const struct result_config *baseline_config, const struct result_point *baseline, int baseline_count,
+                    const struct result_config *config, const struct result_point *points, int count, double min_slowdown);
+
+#endif //SELECTION_BENCHMARK_RESULTS_H
@@ -6,7 +6,6 @@
 
 #define G 5
 #define g ((G + 1) / 2)
-#define INSERTION_SORT_THRESHOLD 32
 
 static int med3(int a, int b, int c) {
     return a >= b ? b >= c ? b : a >= c ? c : a :
@@ -137,11 +136,7 @@ static double introduce_bias(double d, double b) {
     return med3d(d + b, 0.5, d - b);
 }
 
-int sampling_pivot(int *arr, int from, int to, int k) {
-    if (to - from <= INSERTION_SORT_THRESHOLD) {
-        return random_pivot(arr, from, to, k);
-    }
-
+int sampling_rank(int from, int to, int k, int *sample_len) {
     int len = (int) pow((double) (to - from), 2. / 3.);
 
     double N = to - from;
@@ -150,7 +145,18 @@ int sampling_pivot(int *arr, int from, int to, int k) {
     double loc = ((n + 1.) / (N + 1.) * (T + 1.) - 1.);
     double sigma = sqrt((loc + 1.) * (n - loc) * (N - n) * (N + 1.) / (n + 2.)) / (n + 1.) / N;
     int sel = (int) (introduce_bias(loc / (n - 1.), 2. * sigma) * (n - 1) + 0.5);
-    sel = med3(0, sel, len - 1);
+
+    *sample_len = len;
+    return med3(0, sel, len - 1);
+}
+
+int sampling_pivot(int *arr, int from, int to, int k) {
+    if (to - from <= INSERTION_SORT_THRESHOLD) {
+        return random_pivot(arr, from, to, k);
+    }
+
+    int len;
+    int sel = sampling_rank(from, to, k, &len);
 
     partial_shuffle(arr, from, from + len, to);
     select(arr, from, from + len, from + sel, sampling_pivot, 0);
@@ -192,11 +198,14 @@ void reset_num_calls(void) {
     bad_pivots = 0;
 }
 
+int partition_at(int *arr, int from, int to, int pivot_loc) {
+    swap(&arr[from], &arr[pivot_loc]); /* prevent pivot element from being at the end */
+    return partition(arr, from, to, arr[from]);
+}
+
 int select(int *arr, int from, int to, int k, choose_pivot strategy, int record) {
     while (to - from > INSERTION_SORT_THRESHOLD) {
-        int pivot_loc = strategy(arr, from, to, k);
-        swap(&arr[from], &arr[pivot_loc]); /* prevent pivot element from being at the end */
-        int p = partition(arr, from, to, arr[from]);
+        int p = partition_at(arr, from, to, strategy(arr, from, to, k));
         if (record) {
             num_calls++;
             int left_len = p - from;
@@ -1,6 +1,8 @@
 #ifndef DETERMINISTIC_SELECT_H
 #define DETERMINISTIC_SELECT_H
 
+#define INSERTION_SORT_THRESHOLD 32
+
 typedef int (*choose_pivot)(int *arr, int from, int to, int k);
 int first_pivot(int *arr, int from, int to, int k);
 int random_pivot(int *arr, int from, int to, int k);
@@ -11,11 +13,17 @@ int deterministic_adaptive_pivot(int *arr, int from, int to, int k);
 int deterministic_strided_pivot(int *arr, int from, int to, int k);
 int deterministic_adaptive_strided_pivot(int *arr, int from, int to, int k);
 int sampling_pivot(int *arr, int from, int to, int k);
+/* The sample size and the (biased) rank within the sample that sampling_pivot() uses for arr[from..to).
+ * Exposed so that selection over other element layouts can follow the same strategy. */
+int sampling_rank(int from, int to, int k, int *sample_len);
 
 int get_num_calls(void);
 int get_bad_pivot_count(void);
 void reset_num_calls(void);
 
+/* Partitions arr[from..to) around arr[pivot_loc] and returns the boundary p such that
+ * arr[from..p) <= arr[p..to). */
+int partition_at(int *arr, int from, int to, int pivot_loc);
 int select(int *arr, int from, int to, int k, choose_pivot strategy, int record);
 
 int check_select(const int *arr, int from, int to, int k, int n);
@@ -6,3 +6,15 @@ int select_cpp(int *arr, int from, int to, int k) {
     std::nth_element(arr + from, arr + k, arr + to);
     return arr[k];
 }
+
+void partial_sort_cpp(int *arr, int from, int to, int k) {
+    std::partial_sort(arr + from, arr + from + k, arr + to);
+}
+
+void nth_element_sort_cpp(int *arr, int from, int to, int k) {
+    if (k <= 0) {
+        return;
+    }
+    std::nth_element(arr + from, arr + from + k - 1, arr + to);
+    std::sort(arr + from, arr + from + k - 1);
+}
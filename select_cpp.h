@@ -8,6 +8,9 @@ extern "C" {
 #endif
 
 int select_cpp(int *arr, int from, int to, int k);
+/* top-k counterparts of top_k_smallest(): leave the k smallest elements sorted at the front */
+void partial_sort_cpp(int *arr, int from, int to, int k);
+void nth_element_sort_cpp(int *arr, int from, int to, int k);
 
 #ifdef __cplusplus
 }
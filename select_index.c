@@ -0,0 +1,80 @@
+#include "select_index.h"
+#include "array.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void select_index_init(struct select_index *idx, int *arr, int n) {
+    idx->arr = arr;
+    idx->n = n;
+    idx->splitters = NULL;
+    idx->count = 0;
+    idx->capacity = 0;
+}
+
+void select_index_free(struct select_index *idx) {
+    free(idx->splitters);
+    idx->splitters = NULL;
+    idx->count = 0;
+    idx->capacity = 0;
+}
+
+/* returns the number of splitters <= k */
+static int upper_bound(const struct select_index *idx, int k) {
+    int lo = 0, hi = idx->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (idx->splitters[mid] <= k) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void add_splitter(struct select_index *idx, int p) {
+    if (p <= 0 || p >= idx->n) {
+        return;
+    }
+    int i = upper_bound(idx, p);
+    if (i > 0 && idx->splitters[i - 1] == p) {
+        return;
+    }
+    if (idx->count == idx->capacity) {
+        int capacity = idx->capacity == 0 ? 64 : idx->capacity * 2;
+        int *splitters = realloc(idx->splitters, sizeof(int) * capacity);
+        if (splitters == NULL) {
+            return; /* the index is only an optimization, so just forget this splitter */
+        }
+        idx->splitters = splitters;
+        idx->capacity = capacity;
+    }
+    memmove(&idx->splitters[i + 1], &idx->splitters[i], sizeof(int) * (idx->count - i));
+    idx->splitters[i] = p;
+    idx->count++;
+}
+
+int select_index_query(struct select_index *idx, int k, choose_pivot strategy) {
+    int *arr = idx->arr;
+    int i = upper_bound(idx, k);
+    int from = i > 0 ? idx->splitters[i - 1] : 0;
+    int to = i < idx->count ? idx->splitters[i] : idx->n;
+
+    while (to - from > INSERTION_SORT_THRESHOLD) {
+        int p = partition_at(arr, from, to, strategy(arr, from, to, k));
+        add_splitter(idx, p);
+        if (k >= p) {
+            from = p;
+        } else {
+            to = p;
+        }
+    }
+    if (to - from > 1) {
+        insertion_sort(arr, from, to);
+        /* the segment is now sorted, so k can be pinned down exactly */
+        add_splitter(idx, k);
+        add_splitter(idx, k + 1);
+    }
+    return arr[k];
+}
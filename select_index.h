@@ -0,0 +1,21 @@
+#ifndef SELECTION_BENCHMARK_SELECT_INDEX_H
+#define SELECTION_BENCHMARK_SELECT_INDEX_H
+
+#include "select.h"
+
+/* Remembers the partition boundaries left behind by earlier queries on the same array,
+ * so that a later query only has to partition the smallest known segment containing k.
+ * The array must not be modified by anything else while the index is in use. */
+struct select_index {
+    int *arr;
+    int n;
+    int *splitters; /* sorted; every element left of a splitter is <= every element right of it */
+    int count;
+    int capacity;
+};
+
+void select_index_init(struct select_index *idx, int *arr, int n);
+void select_index_free(struct select_index *idx);
+int select_index_query(struct select_index *idx, int k, choose_pivot strategy);
+
+#endif //SELECTION_BENCHMARK_SELECT_INDEX_H
@@ -0,0 +1,105 @@
+#include "select_readonly.h"
+#include "select.h"
+#include "util.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+void select_arena_init(struct select_arena *arena) {
+    arena->data = NULL;
+    arena->capacity = 0;
+}
+
+void select_arena_free(struct select_arena *arena) {
+    free(arena->data);
+    arena->data = NULL;
+    arena->capacity = 0;
+}
+
+static int reserve(struct select_arena *arena, int size) {
+    if (size <= arena->capacity) {
+        return 1;
+    }
+    int *data = realloc(arena->data, sizeof(int) * size);
+    if (data == NULL) {
+        return 0;
+    }
+    arena->data = data;
+    arena->capacity = size;
+    return 1;
+}
+
+int select_readonly(const int *arr, int from, int to, int k, struct select_arena *arena, int *out) {
+    int len = to - from;
+    int s = (int) pow((double) len, 2. / 3.);
+    /* half the width of the band in sample ranks, which starts at about 4 standard deviations of the
+     * sample rank of k and doubles every time k falls outside the band */
+    double spread = 2. * sqrt((double) s);
+    if (len <= INSERTION_SORT_THRESHOLD || s < 2) {
+        s = 0; /* too small to bother with sampling, so the band is everything */
+    }
+
+    while (1) {
+        int lo = INT_MIN, hi = INT_MAX;
+        int bounded_lo = 0, bounded_hi = 0;
+
+        if (s == 0 && !reserve(arena, len)) {
+            return 0;
+        } else if (s > 0) {
+            int loc = (int) ((double) (k - from) * s / len);
+            int lo_rank = loc - (int) spread, hi_rank = loc + (int) spread;
+            /* room for the sample and, with some slack, the expected size of the band */
+            if (!reserve(arena, MAX(s, (int) MIN(2.5 * spread * len / s, (double) len)))) {
+                return 0;
+            }
+            for (int i = 0; i < s; i++) {
+                arena->data[i] = arr[from + (int) (randint() % len)];
+            }
+            if (lo_rank >= 0) {
+                lo = select(arena->data, 0, s, lo_rank, sampling_pivot, 0);
+                bounded_lo = 1;
+            }
+            if (hi_rank < s) {
+                hi = select(arena->data, MAX(lo_rank, 0), s, hi_rank, sampling_pivot, 0);
+                bounded_hi = 1;
+            }
+        }
+
+        /* count the elements below the band and copy the band, as far as it fits. This is written without
+         * branches, since whether an element lands below or in the band is unpredictable. */
+        int less = 0, band = 0;
+        int band_capacity = arena->capacity - 1; /* the last slot takes the writes that do not fit */
+        for (int i = from; i < to; i++) {
+            int x = arr[i];
+            less += x < lo;
+            arena->data[MIN(band, band_capacity)] = x;
+            band += (x >= lo) & (x <= hi);
+        }
+
+        if (k - from < less || k - from >= less + band) {
+            /* the band missed k, so try again with a new sample and a wider band */
+            if (!bounded_lo && !bounded_hi) {
+                assert(!"an unbounded band holds every element");
+                return 0;
+            }
+            spread *= 2.;
+            continue;
+        }
+        if (band > band_capacity) {
+            /* now that the size of the band is known, copy it again into a large enough arena */
+            if (!reserve(arena, band)) {
+                return 0;
+            }
+            band = 0;
+            for (int i = from; i < to; i++) {
+                if (arr[i] >= lo && arr[i] <= hi) {
+                    arena->data[band++] = arr[i];
+                }
+            }
+        }
+        *out = select(arena->data, 0, band, k - from - less, sampling_pivot, 0);
+        return 1;
+    }
+}
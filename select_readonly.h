@@ -0,0 +1,19 @@
+#ifndef SELECTION_BENCHMARK_SELECT_READONLY_H
+#define SELECTION_BENCHMARK_SELECT_READONLY_H
+
+/* Scratch memory for select_readonly(), which grows as needed and can be reused across calls. */
+struct select_arena {
+    int *data;
+    int capacity;
+};
+
+void select_arena_init(struct select_arena *arena);
+void select_arena_free(struct select_arena *arena);
+
+/* Stores the k-th smallest element of arr[from..to) in out without modifying arr.
+ * Only a random sample and then the band of elements between two pivots taken from the sample
+ * are copied into the arena, so it usually needs O((to - from)^(2/3)) scratch memory.
+ * Returns 0 if the arena cannot be grown. */
+int select_readonly(const int *arr, int from, int to, int k, struct select_arena *arena, int *out);
+
+#endif //SELECTION_BENCHMARK_SELECT_READONLY_H
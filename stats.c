@@ -1,23 +1,28 @@
 #include "stats.h"
+#include "util.h"
 
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the sums below are accumulated in double so that long runs do not lose precision */
 
 float mean(const float values[], int count) {
-    float sum = 0;
+    double sum = 0;
     for (int i = 0; i < count; i++) {
         sum += values[i];
     }
-    return sum / (float) count;
+    return (float) (sum / count);
 }
 
 float stddev(const float values[], int count) {
     /* two-step algorithm for better numerical stability */
-    float m = mean(values, count);
-    float sqsum = 0;
+    double m = mean(values, count);
+    double sqsum = 0;
     for (int i = 0; i < count; i++) {
         sqsum += (values[i] - m) * (values[i] - m);
     }
-    return sqrtf(sqsum / (float) (count - 1)); /* sample variance */
+    return (float) sqrt(sqsum / (count - 1)); /* sample variance */
 }
 
 float min(const float values[], int count) {
@@ -39,3 +44,58 @@ float max(const float values[], int count) {
     }
     return values[m];
 }
+
+static int compare_floats(const void *a, const void *b) {
+    float x = *(const float *) a, y = *(const float *) b;
+    return (x > y) - (x < y);
+}
+
+/* p-th percentile (0 <= p <= 1) of sorted values, interpolating linearly between neighbors */
+static double sorted_percentile(const float sorted[], int count, double p) {
+    double pos = p * (count - 1);
+    int i = (int) pos;
+    if (i + 1 >= count) {
+        return sorted[count - 1];
+    }
+    return sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]);
+}
+
+double percentile(const float values[], int count, double p) {
+    float *sorted = malloc(sizeof(float) * count);
+    if (sorted == NULL) {
+        return NAN;
+    }
+    memcpy(sorted, values, sizeof(float) * count);
+    qsort(sorted, count, sizeof(float), compare_floats);
+    double res = sorted_percentile(sorted, count, p);
+    free(sorted);
+    return res;
+}
+
+double median(const float values[], int count) {
+    return percentile(values, count, 0.5);
+}
+
+void bootstrap_median_ci(const float values[], int count, int resamples, double confidence, double *lo, double *hi) {
+    float *sample = malloc(sizeof(float) * count);
+    float *medians = malloc(sizeof(float) * resamples);
+    if (sample == NULL || medians == NULL) {
+        *lo = *hi = NAN;
+        free(sample);
+        free(medians);
+        return;
+    }
+    for (int i = 0; i < resamples; i++) {
+        for (int j = 0; j < count; j++) {
+            sample[j] = values[randint() % count];
+        }
+        qsort(sample, count, sizeof(float), compare_floats);
+        medians[i] = (float) sorted_percentile(sample, count, 0.5);
+    }
+    /* percentile interval of the bootstrap distribution */
+    qsort(medians, resamples, sizeof(float), compare_floats);
+    *lo = sorted_percentile(medians, resamples, (1. - confidence) / 2.);
+    *hi = sorted_percentile(medians, resamples, (1. + confidence) / 2.);
+    free(sample);
+    free(medians);
+}
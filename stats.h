@@ -6,4 +6,11 @@ float stddev(const float values[], int count);
 float min(const float values[], int count);
 float max(const float values[], int count);
 
+/* p-th percentile for 0 <= p <= 1, interpolated linearly */
+double percentile(const float values[], int count, double p);
+double median(const float values[], int count);
+/* Bootstrap percentile confidence interval of the median. Draws from randint(), so the caller should
+ * reseed before anything that depends on the random sequence. */
+void bootstrap_median_ci(const float values[], int count, int resamples, double confidence, double *lo, double *hi);
+
 #endif /* DETERMINISTIC_SELECT_STATS_H */
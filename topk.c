@@ -0,0 +1,108 @@
+#include "topk.h"
+#include "array.h"
+#include "util.h"
+
+static void swap(int *a, int *b) {
+    int tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/* quicksort driven by the same partition step as select(), recursing into the smaller side */
+static void sort_range(int *arr, int from, int to) {
+    while (to - from > INSERTION_SORT_THRESHOLD) {
+        int p = partition_at(arr, from, to, ninther_pivot(arr, from, to, (from + to) / 2));
+        if (p - from < to - p) {
+            sort_range(arr, from, p);
+            from = p;
+        } else {
+            sort_range(arr, p, to);
+            to = p;
+        }
+    }
+    insertion_sort(arr, from, to);
+}
+
+/* binary heap rooted at heap[0]; a max-heap if max_heap is set, a min-heap otherwise */
+static int heap_before(int a, int b, int max_heap) {
+    return max_heap ? a > b : a < b;
+}
+
+static void sift_down(int *heap, int i, int size, int max_heap) {
+    int tmp = heap[i];
+    while (2 * i + 1 < size) {
+        int child = 2 * i + 1;
+        if (child + 1 < size && heap_before(heap[child + 1], heap[child], max_heap)) {
+            child++;
+        }
+        if (!heap_before(heap[child], tmp, max_heap)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = tmp;
+}
+
+/* keeps the k elements of heap[0..k) and rest[0..len) that come first in heap order in heap[0..k),
+ * then heap sorts them so that they end up in ascending (max-heap) or descending (min-heap) order */
+static void heap_select(int *heap, int k, int *rest, int len, int max_heap) {
+    for (int i = k / 2 - 1; i >= 0; i--) {
+        sift_down(heap, i, k, max_heap);
+    }
+    for (int i = 0; i < len; i++) {
+        if (heap_before(heap[0], rest[i], max_heap)) {
+            swap(&rest[i], &heap[0]);
+            sift_down(heap, 0, k, max_heap);
+        }
+    }
+    for (int size = k - 1; size > 0; size--) {
+        swap(&heap[0], &heap[size]);
+        sift_down(heap, 0, size, max_heap);
+    }
+}
+
+void top_k_select(int *arr, int from, int to, int k, choose_pivot strategy) {
+    k = MIN(k, to - from);
+    if (k <= 0) {
+        return;
+    }
+    if (k < to - from) {
+        select(arr, from, to, from + k - 1, strategy, 0);
+    }
+    sort_range(arr, from, from + k);
+}
+
+void top_k_heap(int *arr, int from, int to, int k) {
+    k = MIN(k, to - from);
+    if (k <= 0) {
+        return;
+    }
+    heap_select(arr + from, k, arr + from + k, to - from - k, 1);
+}
+
+void top_k_smallest(int *arr, int from, int to, int k, choose_pivot strategy) {
+    if (k <= TOP_K_HEAP_THRESHOLD) {
+        top_k_heap(arr, from, to, k);
+    } else {
+        top_k_select(arr, from, to, k, strategy);
+    }
+}
+
+void top_k_largest(int *arr, int from, int to, int k, choose_pivot strategy) {
+    k = MIN(k, to - from);
+    if (k <= 0) {
+        return;
+    }
+    if (k <= TOP_K_HEAP_THRESHOLD) {
+        heap_select(arr + to - k, k, arr + from, to - from - k, 0);
+        for (int i = to - k, j = to - 1; i < j; i++, j--) {
+            swap(&arr[i], &arr[j]); /* the min-heap leaves them in descending order */
+        }
+        return;
+    }
+    if (k < to - from) {
+        select(arr, from, to, to - k, strategy, 0);
+    }
+    sort_range(arr, to - k, to);
+}
@@ -0,0 +1,18 @@
+#ifndef SELECTION_BENCHMARK_TOPK_H
+#define SELECTION_BENCHMARK_TOPK_H
+
+#include "select.h"
+
+/* k values up to this use the heap instead of selection in top_k_smallest() and top_k_largest() */
+#define TOP_K_HEAP_THRESHOLD 8
+
+/* Rearranges arr[from..to) so that arr[from..from + k) holds the k smallest elements in ascending order. */
+void top_k_smallest(int *arr, int from, int to, int k, choose_pivot strategy);
+/* Rearranges arr[from..to) so that arr[to - k..to) holds the k largest elements in ascending order. */
+void top_k_largest(int *arr, int from, int to, int k, choose_pivot strategy);
+
+/* The two halves of top_k_smallest(), exposed so that they can be benchmarked separately. */
+void top_k_select(int *arr, int from, int to, int k, choose_pivot strategy);
+void top_k_heap(int *arr, int from, int to, int k);
+
+#endif //SELECTION_BENCHMARK_TOPK_H
@@ -0,0 +1,160 @@
+#include "window.h"
+#include "util.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+int sliding_window_init(struct sliding_window *w, int size) {
+    w->size = size;
+    w->count = 0;
+    w->head = 0;
+    w->bucket_max = MAX(16, 2 * (int) sqrt((double) size));
+    w->bucket_count = 0;
+    /* adjacent buckets are merged when they fit in half a bucket, so there are at most this many */
+    int chunks = (int) (2 * (size_t) size / (size_t) (w->bucket_max / 2) + 2);
+    w->ring = malloc(sizeof(int) * size);
+    w->buckets = malloc(sizeof(struct window_bucket) * chunks);
+    w->pool = malloc(sizeof(int) * (size_t) w->bucket_max * (size_t) chunks);
+    w->free_chunks = malloc(sizeof(int *) * chunks);
+    if (w->ring == NULL || w->buckets == NULL || w->pool == NULL || w->free_chunks == NULL) {
+        sliding_window_free(w);
+        return 0;
+    }
+    for (int i = 0; i < chunks; i++) {
+        w->free_chunks[i] = &w->pool[(size_t) (chunks - 1 - i) * (size_t) w->bucket_max];
+    }
+    w->free_count = chunks;
+    return 1;
+}
+
+void sliding_window_free(struct sliding_window *w) {
+    free(w->ring);
+    free(w->buckets);
+    free(w->pool);
+    free(w->free_chunks);
+    w->ring = NULL;
+    w->buckets = NULL;
+    w->pool = NULL;
+    w->free_chunks = NULL;
+}
+
+/* returns the first bucket whose largest element is >= value, or the last bucket if there is none */
+static int find_bucket(const struct sliding_window *w, int value) {
+    int lo = 0, hi = w->bucket_count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        const struct window_bucket *b = &w->buckets[mid];
+        if (b->data[b->size - 1] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* returns the first position in data[0..size) whose element is >= value */
+static int lower_bound(const int *data, int size, int value) {
+    int lo = 0, hi = size;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (data[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void remove_bucket(struct sliding_window *w, int i) {
+    w->free_chunks[w->free_count++] = w->buckets[i].data;
+    memmove(&w->buckets[i], &w->buckets[i + 1], sizeof(struct window_bucket) * (w->bucket_count - i - 1));
+    w->bucket_count--;
+}
+
+static void add_bucket(struct sliding_window *w, int i) {
+    memmove(&w->buckets[i + 1], &w->buckets[i], sizeof(struct window_bucket) * (w->bucket_count - i));
+    w->buckets[i].data = w->free_chunks[--w->free_count];
+    w->buckets[i].size = 0;
+    w->bucket_count++;
+}
+
+/* appends bucket i + 1 to bucket i */
+static void merge_buckets(struct sliding_window *w, int i) {
+    struct window_bucket *left = &w->buckets[i], *right = &w->buckets[i + 1];
+    memcpy(&left->data[left->size], right->data, sizeof(int) * right->size);
+    left->size += right->size;
+    remove_bucket(w, i + 1);
+}
+
+static void sorted_insert(struct sliding_window *w, int value) {
+    if (w->bucket_count == 0) {
+        add_bucket(w, 0);
+    }
+    int i = find_bucket(w, value);
+    struct window_bucket *b = &w->buckets[i];
+    int pos = lower_bound(b->data, b->size, value);
+    memmove(&b->data[pos + 1], &b->data[pos], sizeof(int) * (b->size - pos));
+    b->data[pos] = value;
+    b->size++;
+
+    if (b->size == w->bucket_max) {
+        /* split into two halves */
+        add_bucket(w, i + 1);
+        struct window_bucket *left = &w->buckets[i], *right = &w->buckets[i + 1];
+        right->size = left->size / 2;
+        left->size -= right->size;
+        memcpy(right->data, &left->data[left->size], sizeof(int) * right->size);
+    }
+}
+
+static void sorted_remove(struct sliding_window *w, int value) {
+    int i = find_bucket(w, value);
+    struct window_bucket *b = &w->buckets[i];
+    int pos = lower_bound(b->data, b->size, value);
+    memmove(&b->data[pos], &b->data[pos + 1], sizeof(int) * (b->size - pos - 1));
+    b->size--;
+
+    if (b->size == 0) {
+        remove_bucket(w, i);
+        return;
+    }
+    /* merge with a neighbor if both fit in half a bucket, so that every two adjacent buckets hold more
+     * than half a bucket, which bounds the number of buckets */
+    int half = w->bucket_max / 2;
+    if (i + 1 < w->bucket_count && b->size + w->buckets[i + 1].size <= half) {
+        merge_buckets(w, i);
+    } else if (i > 0 && w->buckets[i - 1].size + b->size <= half) {
+        merge_buckets(w, i - 1);
+    }
+}
+
+void sliding_window_insert(struct sliding_window *w, int value) {
+    w->ring[(w->head + w->count) % w->size] = value;
+    w->count++;
+    sorted_insert(w, value);
+}
+
+void sliding_window_evict(struct sliding_window *w) {
+    sorted_remove(w, w->ring[w->head]);
+    w->head = (w->head + 1) % w->size;
+    w->count--;
+}
+
+void sliding_window_push(struct sliding_window *w, int value) {
+    if (w->count == w->size) {
+        sliding_window_evict(w);
+    }
+    sliding_window_insert(w, value);
+}
+
+int sliding_window_rank(const struct sliding_window *w, int k) {
+    int i = 0;
+    while (k >= w->buckets[i].size) {
+        k -= w->buckets[i].size;
+        i++;
+    }
+    return w->buckets[i].data[k];
+}
@@ -0,0 +1,39 @@
+#ifndef SELECTION_BENCHMARK_WINDOW_H
+#define SELECTION_BENCHMARK_WINDOW_H
+
+/* Order statistics over a sliding window. The window contents are kept sorted in a list of buckets
+ * of about sqrt(size) elements each, so that insert, evict and rank queries all take O(sqrt(size)),
+ * while the arrival order is kept in a ring buffer to know which element to evict. */
+
+struct window_bucket {
+    int *data;
+    int size;
+};
+
+struct sliding_window {
+    int size;       /* the maximum number of elements in the window */
+    int count;
+    int *ring;      /* the elements in arrival order, oldest at ring[head] */
+    int head;
+    int bucket_max; /* buckets are split when they grow past this */
+    struct window_bucket *buckets;
+    int bucket_count;
+    int *pool;      /* storage for the buckets, in chunks of bucket_max elements */
+    int **free_chunks;
+    int free_count;
+};
+
+/* Returns 0 if allocation fails. */
+int sliding_window_init(struct sliding_window *w, int size);
+void sliding_window_free(struct sliding_window *w);
+
+/* Inserts a new element. The window must not be full. */
+void sliding_window_insert(struct sliding_window *w, int value);
+/* Removes the oldest element. The window must not be empty. */
+void sliding_window_evict(struct sliding_window *w);
+/* Evicts the oldest element if the window is full, then inserts value. */
+void sliding_window_push(struct sliding_window *w, int value);
+/* Returns the k-th smallest element currently in the window (0 <= k < count). */
+int sliding_window_rank(const struct sliding_window *w, int k);
+
+#endif //SELECTION_BENCHMARK_WINDOW_H